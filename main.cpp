@@ -0,0 +1,39 @@
+// Entry point of the Permission Set Comparator; the window is in perm_set_calculator.cpp.
+
+#include "permcalc_window.h"
+#include "permcalc_watchdog.h"
+
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QMainWindow>
+#include <QtGui/QIcon>
+
+#include <memory>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <shlobj.h>
+#endif
+
+int main(int argc, char *argv[]) {
+    markStartup("main");
+    QApplication app(argc, argv);
+    markStartup("qapplication");
+
+    app.setWindowIcon(appIcon());
+    // Freezes of the event loop are logged with the stage that caused them.
+    StallWatchdog watchdog(StallWatchdog::defaultLogPath());
+    startConfiguredSessionRecording();
+
+#ifdef _WIN32
+    // Set AppUserModelID for proper taskbar grouping/icon usage
+    const wchar_t *appId = L"com.vivint.salesforce.permcalc";
+    // Errors are non-critical; ignore return value
+    SetCurrentProcessExplicitAppUserModelID(appId);
+#endif
+
+    std::unique_ptr<QMainWindow> window(createPermissionSetCalculator());
+    window->show();
+    markStartup("window_shown");
+
+    return app.exec();
+}
@@ -10,207 +10,1754 @@
 #include <QtWidgets/QLabel>
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QHBoxLayout>
-#include <QtWidgets/QTableWidget>
 #include <QtWidgets/QHeaderView>
-#include <QtWidgets/QTableWidgetItem>
+#include <QtWidgets/QStatusBar>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QFileDialog>
+#include <QtWidgets/QInputDialog>
+#include <QtWidgets/QLineEdit>
+#include <QtWidgets/QMessageBox>
+#include <QtWidgets/QMenuBar>
+#include <QtWidgets/QMenu>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QScrollBar>
+#include <QtWidgets/QStackedWidget>
+#include <QtWidgets/QListView>
 #include <QtGui/QFont>
 #include <QtGui/QIcon>
-#include <QtCore/QRegularExpression>
+#include <QtGui/QAction>
+#include <QtGui/QDragEnterEvent>
+#include <QtGui/QDropEvent>
+#include <QtGui/QSyntaxHighlighter>
+#include <QtGui/QTextCharFormat>
+#include <QtGui/QTextBlock>
+#include <QtGui/QTextDocument>
+#include <QtCore/QMimeData>
+#include <QtCore/QUrl>
+#include <QtCore/QPointer>
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QAbstractListModel>
+#include <QtCore/QQueue>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QThread>
 #include <QtCore/QSet>
 #include <QtCore/QMap>
 #include <QtCore/QStringList>
 #include <QtCore/QFileInfo>
 #include <QtCore/QDir>
 #include <QtCore/QFile>
-#include <QtCore/QTextStream>
-
-#ifdef _WIN32
-#include <windows.h>
-#include <shlobj.h>
-#endif
-
-// Regex equivalents
-static const QRegularExpression DATE_RE(QStringLiteral("^\\d{1,2}/\\d{1,2}/\\d{2,4}$"));
-static const QRegularExpression ACTION_DATE_RE(
-    QStringLiteral("^(?:add|del|delete|remove)\\s+\\d{1,2}/\\d{1,2}/\\d{2,4}$"),
-    QRegularExpression::CaseInsensitiveOption
-);
-
-static QStringList tokenizeLine(const QString &rawLine) {
-    if (rawLine.contains('\t')) {
-        QStringList parts = rawLine.split('\t');
-        QStringList tokens;
-        for (const QString &p : parts) {
-            QString trimmed = p.trimmed();
-            if (!trimmed.isEmpty()) tokens << trimmed;
-        }
-        return tokens;
-    }
-
-    // Split by 2+ spaces
-    QRegularExpression multiSpace("\\s{2,}");
-    QStringList parts = rawLine.trimmed().split(multiSpace);
-    QStringList tokens;
-    for (const QString &p : parts) {
-        if (!p.isEmpty()) tokens << p;
-    }
-    if (tokens.size() > 1) return tokens;
-
-    // Fallback: comma separated
-    if (rawLine.contains(',')) {
-        parts = rawLine.split(',');
-        tokens.clear();
-        for (const QString &p : parts) {
-            QString trimmed = p.trimmed();
-            if (!trimmed.isEmpty()) tokens << trimmed;
-        }
-        return tokens;
-    }
-    return QStringList{ rawLine.trimmed() };
+#include <QtCore/QHash>
+#include <QtCore/QSaveFile>
+#include <QtCore/QSettings>
+#include <QtCore/QDateTime>
+#include <QtCore/QTimer>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QScopedValueRollback>
+#include <QtCore/QStandardPaths>
+
+#include <memory>
+#include <optional>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+#include "permcalc_core.h"
+#include "permcalc_jobs.h"
+#include "permcalc_ring.h"
+#include "permcalc_session.h"
+#include "permcalc_templates.h"
+#include "permcalc_watchdog.h"
+#include "permcalc_theme.h"
+#include "permcalc_window.h"
+
+// Line counts of the names in one input box. Shared with the blocks' user data so
+// that a deleted block, which is never highlighted again, still gives its name back.
+struct LineNameIndex {
+    QHash<QString, int> names;  // exact names, for comparing with the other box
+    QHash<QString, int> folded; // lower-cased names, for duplicates
+    quint64 generation = 0;     // bumped whenever any line's status may have changed
+
+    void add(const QString &name, const QString &key) {
+        ++names[name];
+        ++folded[key];
+    }
+    void remove(const QString &name, const QString &key) {
+        if (--names[name] == 0) names.remove(name);
+        if (--folded[key] == 0) folded.remove(key);
+    }
+};
+
+struct LineName : QTextBlockUserData {
+    explicit LineName(std::shared_ptr<LineNameIndex> owner) : index(std::move(owner)) {}
+    ~LineName() override {
+        if (!name.isEmpty()) index->remove(name, key);
+    }
+
+    std::shared_ptr<LineNameIndex> index;
+    QString name;
+    QString key;
+    quint64 generation = 0;
+};
+
+// Colors each line of an input box by status: unknown to the catalog, a duplicate
+// (case-insensitively) of another line, or absent from the other box. Qt only
+// highlights the blocks an edit touches; when that changes another line's status,
+// the index generation is bumped and only the visible stale blocks are redone, the
+// rest as they scroll into view.
+class PermissionHighlighter : public QSyntaxHighlighter {
+public:
+    enum class Side { Primary, Mirror };
+
+    PermissionHighlighter(QPlainTextEdit *editor, Side side)
+        : QSyntaxHighlighter(editor->document()), editor(editor),
+          lines(std::make_shared<LineNameIndex>()) {
+        unknownFormat.setFontItalic(true);
+        unknownFormat.setForeground(QColor("#8a8d91"));
+        unknownFormat.setUnderlineStyle(QTextCharFormat::DotLine);
+        duplicateFormat.setBackground(QColor("#fff4d6"));
+        otherSideFormat.setFontWeight(QFont::DemiBold);
+        otherSideFormat.setForeground(QColor(side == Side::Mirror ? "#c53030" : "#b7791f"));
+
+        refreshTimer = new QTimer(this);
+        refreshTimer->setSingleShot(true);
+        refreshTimer->setInterval(30);
+        connect(refreshTimer, &QTimer::timeout, this, &PermissionHighlighter::rehighlightVisible);
+        connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, &PermissionHighlighter::rehighlightVisible);
+        connect(editor->document(), &QTextDocument::contentsChange, this, [this](int, int removed, int) {
+            if (removed > 0) linesChanged();
+        });
+    }
+
+    void setCatalog(const CatalogSnapshot &snapshot) {
+        catalog = snapshot;
+        invalidate();
+    }
+
+    void setCounterpart(PermissionHighlighter *other) {
+        counterpart = other;
+        invalidate();
+    }
+
+protected:
+    void highlightBlock(const QString &text) override {
+        auto *data = static_cast<LineName *>(currentBlockUserData());
+        if (!data) {
+            data = new LineName(lines);
+            setCurrentBlockUserData(data);
+        }
+
+        const QStringView name = extractPermissionName(QStringView(text), tokens, matches);
+        if (name != QStringView(data->name)) {
+            if (!data->name.isEmpty()) lines->remove(data->name, data->key);
+            data->name = name.toString();
+            data->key = name.toString().toLower();
+            if (!data->name.isEmpty()) lines->add(data->name, data->key);
+            linesChanged();
+        }
+        data->generation = lines->generation;
+        if (data->name.isEmpty()) return;
+
+        const int start = int(name.data() - text.constData());
+        const int length = int(name.size());
+        if (lines->folded.value(data->key) > 1) setFormat(0, int(text.size()), duplicateFormat);
+        if (catalog && catalog->nameIds.find(name) == catalog->nameIds.end()) {
+            setFormat(start, length, mergedFormat(start, unknownFormat));
+        }
+        if (counterpart && !counterpart->lines->names.isEmpty() && !counterpart->lines->names.contains(data->name)) {
+            setFormat(start, length, mergedFormat(start, otherSideFormat));
+        }
+    }
+
+private:
+    QTextCharFormat mergedFormat(int position, const QTextCharFormat &extra) const {
+        QTextCharFormat merged = format(position);
+        merged.merge(extra);
+        return merged;
+    }
+
+    // Some other line's status may differ now: here through duplicates, in the
+    // other box through the cross-box comparison.
+    void linesChanged() {
+        invalidate();
+        if (counterpart) counterpart->invalidate();
+    }
+
+    void invalidate() {
+        ++lines->generation;
+        refreshTimer->start();
+    }
+
+    void rehighlightVisible() {
+        QTextBlock block = editor->cursorForPosition(QPoint(0, 0)).block();
+        const QTextBlock last = editor->cursorForPosition(QPoint(0, editor->viewport()->height() - 1)).block();
+        while (block.isValid()) {
+            const auto *data = static_cast<const LineName *>(block.userData());
+            if (!data || data->generation != lines->generation) rehighlightBlock(block);
+            if (block == last) break;
+            block = block.next();
+        }
+    }
+
+    QPlainTextEdit *editor;
+    std::shared_ptr<LineNameIndex> lines;
+    QPointer<PermissionHighlighter> counterpart;
+    CatalogSnapshot catalog;
+    std::pmr::vector<QStringView> tokens;
+    std::pmr::vector<NoisePhraseMatcher::Match> matches;
+    QTimer *refreshTimer{nullptr};
+    QTextCharFormat unknownFormat;
+    QTextCharFormat duplicateFormat;
+    QTextCharFormat otherSideFormat;
+};
+
+// Pastes of at least this many lines bypass the text editor; see PermissionInputPane.
+static const int LARGE_INPUT_LINES = 20000;
+
+class PermissionInputArea : public QPlainTextEdit {
+    Q_OBJECT
+public:
+    PermissionInputArea(const QString &placeholder, PermissionHighlighter::Side side, QWidget *parent = nullptr)
+        : QPlainTextEdit(parent), mirror(side == PermissionHighlighter::Side::Mirror) {
+        setPlaceholderText(placeholder);
+        setLineWrapMode(QPlainTextEdit::NoWrap);
+        lineStatus = new PermissionHighlighter(this, side);
+        connect(this, &QPlainTextEdit::textChanged, this, &PermissionInputArea::sanitizeText);
+        connect(document(), &QTextDocument::contentsChange, this, &PermissionInputArea::recordEdit);
+    }
+
+    PermissionHighlighter *highlighter() const { return lineStatus; }
+    bool isMirror() const { return mirror; }
+
+    // Replaces the whole text without recording it as an edit of the session.
+    void replaceText(const QString &text) {
+        QScopedValueRollback<bool> quiet(programmatic, true);
+        setPlainText(text);
+    }
+
+    // Repeat a recorded paste or edit; positions past the end are clamped.
+    void replayPaste(int position, int removed, const QString &text) {
+        setTextCursor(rangeCursor(position, removed));
+        QMimeData data;
+        data.setText(text);
+        insertFromMimeData(&data);
+    }
+
+    void replayEdit(int position, int removed, const QString &text) {
+        rangeCursor(position, removed).insertText(text);
+    }
+
+signals:
+    // The whole text after a paste of LARGE_INPUT_LINES or more, which was not
+    // inserted into the document: the current text with the selection, or nothing
+    // at the caret, replaced by the paste.
+    void largeTextPasted(const QString &text);
+
+protected:
+    // File drops are handled by the window as a batch comparison, not pasted as text.
+    bool canInsertFromMimeData(const QMimeData *source) const override {
+        return !source->hasUrls() && QPlainTextEdit::canInsertFromMimeData(source);
+    }
+
+    void insertFromMimeData(const QMimeData *source) override {
+        if (!source->hasText()) {
+            QPlainTextEdit::insertFromMimeData(source);
+            return;
+        }
+        const QString text = source->text();
+        const QTextCursor selection = textCursor();
+        QElapsedTimer timer;
+        timer.start();
+        {
+            // The paste is recorded as one event below, not as the edits it causes.
+            QScopedValueRollback<bool> quiet(programmatic, true);
+            StageScope stage("paste", { { "chars", text.size() } });
+            if (text.count(u'\n') + 1 >= LARGE_INPUT_LINES) {
+                // The document the paste would have produced: the selection, or
+                // nothing at the caret, replaced by the pasted text.
+                QString combined = toPlainText();
+                combined.replace(selection.selectionStart(), selection.selectionEnd() - selection.selectionStart(), text);
+                emit largeTextPasted(combined);
+            } else {
+                QPlainTextEdit::insertFromMimeData(source);
+            }
+        }
+        if (SessionRecorder *recorder = sessionRecorder()) {
+            SessionEvent event;
+            event.type = SessionEvent::Type::Paste;
+            event.mirror = mirror;
+            event.position = selection.selectionStart();
+            event.removed = selection.selectionEnd() - selection.selectionStart();
+            event.text = text;
+            event.durationMs = timer.nsecsElapsed() / 1e6;
+            recorder->record(std::move(event));
+        }
+    }
+
+private slots:
+    void sanitizeText() {
+        QString text = toPlainText();
+        StageScope stage("sanitizeText", { { "lines", blockCount() }, { "chars", text.size() } });
+        QStringList sanitizedLines = extractPermissionNames(text);
+        QString sanitized = sanitizedLines.join('\n');
+        if (text == sanitized) return;
+        QSignalBlocker blocker(this); // RAII blocks signals
+        QScopedValueRollback<bool> quiet(programmatic, true);
+        setPlainText(sanitized);
+        QTextCursor c = textCursor();
+        c.movePosition(QTextCursor::End);
+        setTextCursor(c);
+    }
+
+    // Typing, deleting, undo and the like. Each change is recorded on its own, so a
+    // typed name arrives as one event per keystroke.
+    void recordEdit(int position, int removed, int added) {
+        SessionRecorder *recorder = sessionRecorder();
+        if (!recorder || programmatic) return;
+        QTextCursor inserted(document());
+        inserted.setPosition(position);
+        inserted.setPosition(position + added, QTextCursor::KeepAnchor);
+        SessionEvent event;
+        event.type = SessionEvent::Type::Edit;
+        event.mirror = mirror;
+        event.position = position;
+        event.removed = removed;
+        // QTextCursor separates lines with U+2029.
+        event.text = inserted.selectedText().replace(QChar::ParagraphSeparator, u'\n');
+        recorder->record(std::move(event));
+    }
+
+private:
+    QTextCursor rangeCursor(int position, int length) {
+        QTextCursor cursor(document());
+        const int end = document()->characterCount() - 1;
+        cursor.setPosition(std::clamp(position, 0, end));
+        cursor.setPosition(std::clamp(position + length, 0, end), QTextCursor::KeepAnchor);
+        return cursor;
+    }
+
+    PermissionHighlighter *lineStatus{nullptr};
+    const bool mirror;
+    bool programmatic = false; // set while the text changes by other means than editing
+};
+
+// Unique names of a large paste. Names the catalog knows share the catalog's
+// strings, so memory grows with the names the catalog does not know.
+class PermissionNameListModel : public QAbstractListModel {
+public:
+    using QAbstractListModel::QAbstractListModel;
+
+    void setNames(const QStringList &parsed) {
+        beginResetModel();
+        list = parsed;
+        endResetModel();
+    }
+
+    // One insert for the whole batch, so the view lays out once per batch.
+    void appendNames(const QStringList &batch) {
+        if (batch.isEmpty()) return;
+        beginInsertRows(QModelIndex(), int(list.size()), int(list.size() + batch.size()) - 1);
+        list += batch;
+        endInsertRows();
+    }
+
+    const QStringList &names() const { return list; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : int(list.size());
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override {
+        if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+        return list[index.row()];
+    }
+
+private:
+    QStringList list;
+};
+
+// A catalog name shares the catalog's string instead of holding its own copy.
+static QString internName(QStringView name, const CatalogSnapshot &catalog) {
+    if (catalog) {
+        const auto it = catalog->nameIds.find(name);
+        if (it != catalog->nameIds.end()) return catalog->names[qsizetype(it->second)];
+    }
+    return name.toString();
 }
 
-static QString extractPermissionName(const QString &rawLine) {
-    QString line = rawLine.trimmed();
-    if (line.isEmpty()) return QString();
-
-    QString lowered = line.toLower();
-    if (lowered.contains("permission set name") && lowered.contains("action")) return QString();
-    if (ACTION_DATE_RE.match(line).hasMatch()) return QString();
-
-    QStringList tokens = tokenizeLine(rawLine);
-    if (tokens.isEmpty()) return QString();
-
-    for (const QString &token : tokens) {
-        QString trimmed = token.trimmed();
-        QString loweredToken = trimmed.toLower();
-        if (trimmed.isEmpty()) continue;
-        if (loweredToken == "add" || loweredToken == "del" || loweredToken == "delete" || loweredToken == "remove") continue;
-        if (DATE_RE.match(trimmed).hasMatch()) continue;
-        if (loweredToken.contains("expires on") || loweredToken.contains("date assigned")) continue;
-        if (loweredToken.contains("permission set name")) return QString();
-        return trimmed; // first valid token
-    }
-
-    QString fallback = tokens.first().trimmed();
-    QString fallbackLower = fallback.toLower();
-    if (fallbackLower == "add" || fallbackLower == "del" || fallbackLower == "delete" || fallbackLower == "remove") return QString();
-    if (DATE_RE.match(fallback).hasMatch()) return QString();
-    return fallback;
+// A large paste parsed on a worker thread. The worker pushes the unique names in
+// first-seen order, in batches, and the pane drains them on a frame timer, so the
+// list fills in progressively and the event loop sees one timer tick per frame
+// rather than one queued signal per batch.
+struct LargePasteStream {
+    static constexpr int BatchSize = 2048;
+
+    BatchRing<QStringList> batches{ 64 };
+    std::atomic<bool> cancelled{ false };
+    std::atomic<bool> finished{ false };
+
+    void parse(const QString &text, const CatalogSnapshot &catalog) {
+        QSet<QStringView> seen;
+        std::pmr::vector<QStringView> tokens;
+        std::pmr::vector<NoisePhraseMatcher::Match> matches;
+        QStringList batch;
+        const QStringView all(text);
+        qsizetype start = 0;
+        while (start <= all.size() && !cancelled.load(std::memory_order_relaxed)) {
+            qsizetype end = all.indexOf(u'\n', start);
+            if (end < 0) end = all.size();
+            const QStringView name = extractPermissionName(all.mid(start, end - start), tokens, matches);
+            if (!name.isEmpty() && !seen.contains(name)) {
+                seen.insert(name);
+                batch << internName(name, catalog);
+                if (batch.size() == BatchSize && !push(batch)) return;
+            }
+            start = end + 1;
+        }
+        if (!batch.isEmpty() && !push(batch)) return;
+        finished.store(true, std::memory_order_release);
+    }
+
+    // Waits for room while the GUI catches up; false once the paste is abandoned.
+    bool push(QStringList &batch) {
+        while (!batches.tryPush(batch)) {
+            if (cancelled.load(std::memory_order_relaxed)) return false;
+            QThread::msleep(1);
+        }
+        batch.clear();
+        return true;
+    }
+};
+
+// An input box that holds ordinary input as editable text and a large paste as a
+// read-only list of its unique names. QPlainTextEdit keeps a text block per line,
+// which for a million-line paste means hundreds of MB and sluggish scrolling; the
+// list view lays out only the rows on screen. "Edit as Text" turns the list back
+// into text for the rare edit.
+class PermissionInputPane : public QStackedWidget {
+public:
+    PermissionInputPane(const QString &placeholder, PermissionHighlighter::Side side, QWidget *parent = nullptr)
+        : QStackedWidget(parent) {
+        editor = new PermissionInputArea(placeholder, side);
+        addWidget(editor);
+
+        QWidget *viewer = new QWidget;
+        names = new PermissionNameListModel(viewer);
+        list = new QListView;
+        list->setModel(names);
+        list->setUniformItemSizes(true);
+        list->setEditTriggers(QAbstractItemView::NoEditTriggers);
+        summary = new QLabel;
+        search = new QLineEdit;
+        search->setPlaceholderText("Find (Enter for next match)");
+        search->setClearButtonEnabled(true);
+        QPushButton *editButton = new QPushButton("Edit as Text");
+        editButton->setObjectName("SecondaryButton");
+        editButton->setCursor(Qt::PointingHandCursor);
+        QPushButton *clearButton = new QPushButton("Clear");
+        clearButton->setObjectName("SecondaryButton");
+        clearButton->setCursor(Qt::PointingHandCursor);
+
+        QHBoxLayout *actions = new QHBoxLayout;
+        actions->addWidget(summary, 1);
+        actions->addWidget(editButton);
+        actions->addWidget(clearButton);
+        QVBoxLayout *viewerLayout = new QVBoxLayout(viewer);
+        viewerLayout->setContentsMargins(0, 0, 0, 0);
+        viewerLayout->addWidget(search);
+        viewerLayout->addWidget(list, 1);
+        viewerLayout->addLayout(actions);
+        addWidget(viewer);
+
+        // About one frame at 60 Hz.
+        drainTimer = new QTimer(this);
+        drainTimer->setInterval(16);
+        drainTimer->setTimerType(Qt::PreciseTimer);
+        connect(drainTimer, &QTimer::timeout, this, &PermissionInputPane::drainStream);
+
+        connect(editor, &PermissionInputArea::largeTextPasted, this, &PermissionInputPane::loadLargeText);
+        connect(search, &QLineEdit::textEdited, this, [this] { findNext(false); });
+        connect(search, &QLineEdit::returnPressed, this, [this] { findNext(true); });
+        connect(editButton, &QPushButton::clicked, this, &PermissionInputPane::editAsText);
+        connect(clearButton, &QPushButton::clicked, this, [this] {
+            recordAction(SessionEvent::Type::Clear);
+            showEditor(QString());
+        });
+    }
+
+    // A worker that is still parsing would otherwise wait for room in the ring forever.
+    ~PermissionInputPane() override { cancelStream(); }
+
+    // The text to compare. A large paste is still returned while it is being parsed.
+    QString toPlainText() const {
+        if (currentWidget() == editor) return editor->toPlainText();
+        return pendingText.isNull() ? names->names().join(u'\n') : pendingText;
+    }
+
+    PermissionHighlighter *highlighter() const { return editor->highlighter(); }
+
+    void setCatalog(const CatalogSnapshot &snapshot) {
+        catalog = snapshot;
+        editor->highlighter()->setCatalog(snapshot);
+    }
+
+    // Replaces the contents, e.g. with a role template.
+    void setText(const QString &text) { showEditor(text); }
+
+    void replayPaste(int position, int removed, const QString &text) { editor->replayPaste(position, removed, text); }
+    void replayEdit(int position, int removed, const QString &text) { editor->replayEdit(position, removed, text); }
+    void replayClear() { showEditor(QString()); }
+
+    // As "Edit as Text" without the confirmation. The user could only click it once
+    // the paste was read, so this waits for that first.
+    void replayEditAsText() {
+        while (!pendingText.isNull()) QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+        showEditor(names->names().join(u'\n'));
+    }
+
+private:
+    void recordAction(SessionEvent::Type type) {
+        if (SessionRecorder *recorder = sessionRecorder()) {
+            SessionEvent event;
+            event.type = type;
+            event.mirror = editor->isMirror();
+            recorder->record(std::move(event));
+        }
+    }
+
+    void loadLargeText(const QString &text) {
+        cancelStream();
+        pendingText = text;
+        names->setNames(QStringList());
+        search->clear();
+        summary->setText("Reading pasted text...");
+        {
+            QSignalBlocker blocker(editor);
+            editor->replaceText(QString());
+        }
+        setCurrentIndex(1);
+
+        stream = std::make_shared<LargePasteStream>();
+        JobScheduler::instance().run(JobPriority::Interactive, [text, snapshot = catalog, job = stream] {
+            job->parse(text, snapshot);
+        });
+        drainTimer->start();
+    }
+
+    // Runs once per frame while a paste is being parsed and applies everything the
+    // worker has pushed since the previous frame as one insert.
+    void drainStream() {
+        if (!stream) {
+            drainTimer->stop();
+            return;
+        }
+        // Read before draining: once the worker has finished, whatever it pushed is
+        // in the ring, so an empty ring afterwards means the paste is complete.
+        const bool finished = stream->finished.load(std::memory_order_acquire);
+        QStringList arrived;
+        QStringList batch;
+        while (stream->batches.tryPop(batch)) arrived += batch;
+        names->appendNames(arrived);
+
+        if (finished) {
+            stream.reset();
+            drainTimer->stop();
+            pendingText = QString();
+            summary->setText(QString("%1 permission sets (large paste, read-only)").arg(names->rowCount()));
+        } else if (!arrived.isEmpty()) {
+            summary->setText(QString("Reading pasted text... %1 permission sets so far").arg(names->rowCount()));
+        }
+    }
+
+    void cancelStream() {
+        if (stream) stream->cancelled.store(true, std::memory_order_relaxed);
+        stream.reset();
+        drainTimer->stop();
+    }
+
+    void editAsText() {
+        if (!pendingText.isNull()) return;
+        const QStringList &all = names->names();
+        const auto answer = QMessageBox::question(this, "Edit as Text",
+            QString("Editing %1 lines as text is slow and uses much more memory. Continue?").arg(all.size()));
+        if (answer != QMessageBox::Yes) return;
+        recordAction(SessionEvent::Type::EditAsText);
+        showEditor(all.join(u'\n'));
+    }
+
+    void showEditor(const QString &text) {
+        cancelStream();
+        pendingText = QString();
+        names->setNames(QStringList());
+        search->clear();
+        editor->replaceText(text);
+        setCurrentWidget(editor);
+    }
+
+    // Selects the next name containing the search text, wrapping around. While
+    // typing, the current match is kept if it still matches.
+    void findNext(bool advance) {
+        const QString needle = search->text().trimmed();
+        const QStringList &all = names->names();
+        if (needle.isEmpty() || all.isEmpty()) return;
+        const int count = int(all.size());
+        const int current = list->currentIndex().isValid() ? list->currentIndex().row() : -1;
+        const int start = advance ? current + 1 : std::max(current, 0);
+        for (int i = 0; i < count; ++i) {
+            const int row = (start + i) % count;
+            if (all[row].contains(needle, Qt::CaseInsensitive)) {
+                const QModelIndex index = names->index(row);
+                list->setCurrentIndex(index);
+                list->scrollTo(index, QAbstractItemView::PositionAtCenter);
+                return;
+            }
+        }
+    }
+
+    PermissionInputArea *editor{nullptr};
+    PermissionNameListModel *names{nullptr};
+    QListView *list{nullptr};
+    QLabel *summary{nullptr};
+    QLineEdit *search{nullptr};
+    QTimer *drainTimer{nullptr};
+    CatalogSnapshot catalog;
+    QString pendingText;
+    std::shared_ptr<LargePasteStream> stream;
+};
+
+// Files added with a size are only decoded when a window or the taskbar asks for that size.
+const QIcon &appIcon() {
+    static const QIcon icon = [] {
+        QIcon sizes;
+        for (int size : { 16, 24, 32, 48, 64, 128, 256 }) {
+            sizes.addFile(QString(":/icons/app_%1.png").arg(size), QSize(size, size));
+        }
+        return sizes;
+    }();
+    return icon;
+}
+
+void markStartup(const char *stage) {
+    static const QString tracePath = qEnvironmentVariable("PERMCALC_STARTUP_TRACE");
+    if (tracePath.isEmpty()) return;
+    static QSet<QByteArray> marked;
+    const QByteArray name(stage);
+    if (marked.contains(name)) return;
+    marked.insert(name);
+
+    const qint64 now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    QFile trace(tracePath);
+    if (trace.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        trace.write(name + ' ' + QByteArray::number(now) + '\n');
+    }
+    if (marked.contains("first_paint") && marked.contains("catalog_loaded") && qApp) {
+        QTimer::singleShot(0, qApp, &QCoreApplication::quit);
+    }
+}
+
+static QString resourcePath(const QString &name) {
+    // Resolve relative to application dir.
+    QDir base(QCoreApplication::applicationDirPath());
+    return base.filePath(name);
+}
+
+// Rough heap footprint of a loaded catalog, used for the registry's memory cap.
+static qint64 estimateCatalogBytes(const PermissionCatalog &catalog) {
+    qint64 bytes = 0;
+    for (auto it = catalog.entries.cbegin(); it != catalog.entries.cend(); ++it) {
+        const CatalogEntry &e = it.value();
+        qint64 chars = it.key().size() + e.id.size() + e.apiName.size() + e.name.size() + e.description.size();
+        bytes += chars * qint64(sizeof(QChar)) + 5 * 32; // string headers plus hash node
+    }
+    return bytes;
+}
+
+// The catalogs of every configured org. Each is loaded on first use and the least
+// recently used ones are evicted once the loaded catalogs exceed the memory cap;
+// an evicted snapshot stays valid for anyone still holding it.
+class CatalogRegistry {
+public:
+    void addOrg(const QString &org, const QString &path) {
+        if (!paths.contains(org)) orgNames << org;
+        paths.insert(org, path);
+    }
+
+    QStringList orgs() const { return orgNames; }
+    QString pathFor(const QString &org) const { return paths.value(org); }
+
+    void setMemoryCap(qint64 bytes) {
+        memoryCap = bytes;
+        evictOver(QString());
+    }
+
+    CatalogSnapshot acquire(const QString &org) {
+        auto it = loaded.find(org);
+        if (it == loaded.end()) {
+            if (!paths.contains(org)) return std::make_shared<const PermissionCatalog>();
+            StageScope stage("catalog load", { { "bytes", QFileInfo(paths.value(org)).size() } });
+            auto snapshot = std::make_shared<const PermissionCatalog>(loadCatalog(paths.value(org)));
+            it = loaded.insert(org, Loaded{ snapshot, estimateCatalogBytes(*snapshot) });
+        }
+        CatalogSnapshot snapshot = it->snapshot;
+        touch(org);
+        evictOver(org);
+        return snapshot;
+    }
+
+    // Returns the loaded snapshot without loading or touching the LRU order.
+    CatalogSnapshot peek(const QString &org) const {
+        return loaded.value(org).snapshot;
+    }
+
+    void update(const QString &org, const CatalogSnapshot &snapshot) {
+        loaded.insert(org, Loaded{ snapshot, estimateCatalogBytes(*snapshot) });
+        touch(org);
+        evictOver(org);
+    }
+
+private:
+    struct Loaded {
+        CatalogSnapshot snapshot;
+        qint64 bytes = 0;
+    };
+
+    QStringList orgNames;
+    QHash<QString, QString> paths;
+    QHash<QString, Loaded> loaded;
+    QStringList recent; // least recently used first
+    qint64 memoryCap = 64ll * 1024 * 1024;
+
+    void touch(const QString &org) {
+        recent.removeOne(org);
+        recent << org;
+    }
+
+    void evictOver(const QString &keep) {
+        qint64 total = 0;
+        for (const Loaded &l : loaded) total += l.bytes;
+        for (int i = 0; i < recent.size() && total > memoryCap;) {
+            const QString org = recent[i];
+            if (org == keep) { ++i; continue; }
+            total -= loaded.take(org).bytes;
+            recent.removeAt(i);
+        }
+    }
+};
+
+// Reads catalogs.ini next to the executable:
+//
+//   [orgs]
+//   Production=Permission Sets.csv
+//   UAT=catalogs/uat.csv
+//
+//   [registry]
+//   memoryCapMB=64
+//
+//   [diagnostics]
+//   recordSessions=false
+//
+//   [templates]
+//   path=roles/role_templates.bin
+//
+// Relative paths resolve against the executable's folder. Without the file, the
+// single "Default" org uses "Permission Sets.csv" as before.
+static void loadOrgConfig(CatalogRegistry &registry) {
+    QSettings settings(resourcePath("catalogs.ini"), QSettings::IniFormat);
+    const QDir base(QCoreApplication::applicationDirPath());
+
+    settings.beginGroup("orgs");
+    for (const QString &org : settings.childKeys()) {
+        const QString path = settings.value(org).toString();
+        if (!path.isEmpty()) registry.addOrg(org, QDir::cleanPath(base.absoluteFilePath(path)));
+    }
+    settings.endGroup();
+
+    const int capMb = settings.value("registry/memoryCapMB", 64).toInt();
+    if (capMb > 0) registry.setMemoryCap(qint64(capMb) * 1024 * 1024);
+
+    if (registry.orgs().isEmpty()) registry.addOrg("Default", resourcePath("Permission Sets.csv"));
+}
+
+// Extra header and noise phrases for exports from localized Salesforce UIs.
+static void loadParsingConfig() {
+    QSettings settings(resourcePath("catalogs.ini"), QSettings::IniFormat);
+    const QStringList headers = settings.value("parsing/headerPhrases").toStringList();
+    const QStringList ignored = settings.value("parsing/ignoredPhrases").toStringList();
+    if (!headers.isEmpty() || !ignored.isEmpty()) setExtraNoisePhrases(headers, ignored);
+}
+
+// Role templates live in the app's local data folder unless catalogs.ini points at
+// a shared file, so a team can keep one set of standard roles.
+static QString roleTemplatePath() {
+    QSettings settings(resourcePath("catalogs.ini"), QSettings::IniFormat);
+    const QString configured = settings.value("templates/path").toString();
+    if (!configured.isEmpty()) return QDir::cleanPath(QDir(QCoreApplication::applicationDirPath()).absoluteFilePath(configured));
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("role_templates.bin");
+}
+
+void startConfiguredSessionRecording() {
+    QSettings settings(resourcePath("catalogs.ini"), QSettings::IniFormat);
+    if (!settings.value("diagnostics/recordSessions", false).toBool()) return;
+    const QDir data(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation));
+    startSessionRecording(data.filePath("sessions"));
+}
+
+// Result of re-reading the catalog file: the new index plus the keys whose entries
+// were added, removed or changed relative to the live index.
+struct CatalogReload {
+    CatalogSnapshot snapshot;
+    QSet<QString> changedKeys;
+    int added = 0;
+    int removed = 0;
+    int changed = 0;
+    QString error; // the file could not be read; `snapshot` is the live index
+};
+
+// Parses the catalog file and diffs it by key against the live index. Runs on a
+// worker thread; `live` is never modified. The name index assigns ids by sorted
+// position, so any added or removed name renumbers the names after it; the fresh
+// parse is therefore published as is rather than patched into a copy of `live`.
+static CatalogReload reloadCatalog(const QString &path, const CatalogSnapshot &live) {
+    CatalogReload result;
+    result.snapshot = live;
+    QString text;
+    // Replace-on-save editors briefly delete the file, and others lock it while
+    // writing. Either way the live catalog stays, and no snapshot is written.
+    if (!readTextFile(path, text, &result.error)) return result;
+    auto fresh = std::make_shared<PermissionCatalog>(parseCatalogText(text));
+
+    for (auto it = live->entries.cbegin(); it != live->entries.cend(); ++it) {
+        if (!fresh->entries.contains(it.key())) {
+            result.changedKeys.insert(it.key());
+            ++result.removed;
+        }
+    }
+    for (auto it = fresh->entries.cbegin(); it != fresh->entries.cend(); ++it) {
+        auto current = live->entries.constFind(it.key());
+        if (current == live->entries.cend()) {
+            ++result.added;
+        } else if (*current != it.value()) {
+            ++result.changed;
+        } else {
+            continue;
+        }
+        result.changedKeys.insert(it.key());
+    }
+
+    // Keep the live snapshot when nothing changed so readers never see a new instance.
+    if (!result.changedKeys.isEmpty()) {
+        saveCatalogSnapshot(path, *fresh);
+        result.snapshot = std::move(fresh);
+    }
+    return result;
+}
+
+enum class ExportFormat { Tsv, Csv, JsonLines, DataLoader };
+
+struct ExportRow {
+    QString assigneeId;
+    QString permissionSet;
+    QString permissionSetId;
+    QString description;
+};
+
+struct ExportSummary {
+    qint64 rows = 0;
+    qint64 unresolved = 0; // Data Loader rows dropped for lack of a PermissionSetId
+    QString error;
+};
+
+// Encodes rows one at a time into a fixed-size byte buffer that is handed to the
+// device only when full, so exports of any size never hold more than one chunk.
+class ResultExporter {
+public:
+    ResultExporter(QIODevice *device, ExportFormat format, bool withAssignee)
+        : device(device), format(format), withAssignee(withAssignee) {
+        buffer.reserve(BufferSize + 4096);
+    }
+
+    bool writeHeader() {
+        switch (format) {
+        case ExportFormat::Tsv:
+        case ExportFormat::Csv: {
+            const char sep = format == ExportFormat::Tsv ? '\t' : ',';
+            if (withAssignee) { buffer += "AssigneeId"; buffer += sep; }
+            buffer += "PermissionSet";
+            buffer += sep;
+            buffer += "PermissionSetId";
+            buffer += sep;
+            buffer += "Description\r\n";
+            break;
+        }
+        case ExportFormat::DataLoader:
+            buffer += "AssigneeId,PermissionSetId\r\n";
+            break;
+        case ExportFormat::JsonLines:
+            break;
+        }
+        return flushIfFull();
+    }
+
+    bool writeRow(const ExportRow &row) {
+        switch (format) {
+        case ExportFormat::Tsv:
+            if (withAssignee) { appendTsv(row.assigneeId); buffer += '\t'; }
+            appendTsv(row.permissionSet);
+            buffer += '\t';
+            appendTsv(row.permissionSetId);
+            buffer += '\t';
+            appendTsv(row.description);
+            buffer += "\r\n";
+            break;
+        case ExportFormat::Csv:
+            if (withAssignee) { appendCsv(row.assigneeId); buffer += ','; }
+            appendCsv(row.permissionSet);
+            buffer += ',';
+            appendCsv(row.permissionSetId);
+            buffer += ',';
+            appendCsv(row.description);
+            buffer += "\r\n";
+            break;
+        case ExportFormat::JsonLines:
+            buffer += '{';
+            if (withAssignee) { appendJsonField("assigneeId", row.assigneeId); buffer += ','; }
+            appendJsonField("permissionSet", row.permissionSet);
+            buffer += ',';
+            appendJsonField("permissionSetId", row.permissionSetId);
+            buffer += ',';
+            appendJsonField("description", row.description);
+            buffer += "}\n";
+            break;
+        case ExportFormat::DataLoader:
+            if (row.assigneeId.isEmpty() || row.permissionSetId.isEmpty()) {
+                ++summary.unresolved;
+                return true;
+            }
+            appendCsv(row.assigneeId);
+            buffer += ',';
+            appendCsv(row.permissionSetId);
+            buffer += "\r\n";
+            break;
+        }
+        ++summary.rows;
+        return flushIfFull();
+    }
+
+    bool finish() {
+        return flush();
+    }
+
+    ExportSummary result() const { return summary; }
+
+private:
+    static constexpr qsizetype BufferSize = 1 << 16;
+
+    QIODevice *device;
+    ExportFormat format;
+    bool withAssignee;
+    QByteArray buffer;
+    ExportSummary summary;
+
+    bool flushIfFull() {
+        return buffer.size() < BufferSize || flush();
+    }
+
+    bool flush() {
+        if (buffer.isEmpty()) return summary.error.isEmpty();
+        if (device->write(buffer) != buffer.size()) {
+            summary.error = device->errorString();
+            return false;
+        }
+        buffer.clear(); // keeps capacity
+        return true;
+    }
+
+    void appendTsv(const QString &value) {
+        // Tabs and line breaks would split the row; flatten them to spaces.
+        const qsizetype start = buffer.size();
+        buffer += value.toUtf8();
+        for (qsizetype i = start; i < buffer.size(); ++i) {
+            char &c = buffer[i];
+            if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+        }
+    }
+
+    void appendCsv(const QString &value) {
+        const QByteArray utf8 = value.toUtf8();
+        bool quote = false;
+        for (char c : utf8) {
+            if (c == ',' || c == '"' || c == '\n' || c == '\r') { quote = true; break; }
+        }
+        if (!quote) {
+            buffer += utf8;
+            return;
+        }
+        buffer += '"';
+        for (char c : utf8) {
+            if (c == '"') buffer += '"';
+            buffer += c;
+        }
+        buffer += '"';
+    }
+
+    void appendJsonField(const char *key, const QString &value) {
+        buffer += '"';
+        buffer += key;
+        buffer += "\":\"";
+        const QByteArray utf8 = value.toUtf8();
+        for (char c : utf8) {
+            switch (c) {
+            case '"': buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\n': buffer += "\\n"; break;
+            case '\r': buffer += "\\r"; break;
+            case '\t': buffer += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    buffer += QByteArray("\\u00") + QByteArray::number(static_cast<unsigned char>(c), 16).rightJustified(2, '0');
+                } else {
+                    buffer += c;
+                }
+            }
+        }
+        buffer += '"';
+    }
+};
+
+// Streams the missing permission sets of one comparison to `path`. Names come from
+// nameAt(0) .. nameAt(count - 1) and each row is encoded as it is produced. The output
+// is written through QSaveFile so a failed export never leaves a truncated file behind.
+template <typename NameAt>
+static ExportSummary exportMissingPermissions(const QString &path, ExportFormat format, const QString &assigneeId,
+                                              qsizetype count, NameAt nameAt, const CatalogSnapshot &catalog) {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        ExportSummary failed;
+        failed.error = file.errorString();
+        return failed;
+    }
+
+    ResultExporter exporter(&file, format, !assigneeId.isEmpty());
+    bool ok = exporter.writeHeader();
+    for (qsizetype i = 0; ok && i < count; ++i) {
+        ExportRow row;
+        row.assigneeId = assigneeId;
+        row.permissionSet = nameAt(i);
+        if (const CatalogEntry *entry = catalog->find(row.permissionSet)) {
+            row.permissionSetId = entry->id;
+            row.description = entry->description;
+        }
+        ok = exporter.writeRow(row);
+    }
+    ok = ok && exporter.finish();
+
+    ExportSummary summary = exporter.result();
+    if (ok && !file.commit()) summary.error = file.errorString();
+    return summary;
+}
+
+static ExportSummary exportMissingPermissions(const QString &path, ExportFormat format, const QString &assigneeId,
+                                              const QStringList &missing, const CatalogSnapshot &catalog) {
+    return exportMissingPermissions(path, format, assigneeId, missing.size(),
+                                    [&missing](qsizetype i) { return missing[i]; }, catalog);
+}
+
+// Compares the two texts in a session of its own, the same way the result table
+// does, and writes the missing ids straight from the diff.
+static ExportSummary exportComparison(const QString &path, ExportFormat format, const QString &assigneeId,
+                                      const QString &userText, const QString &mirrorText,
+                                      const CatalogSnapshot &catalog) {
+    ParseSession session;
+    session.reset(catalog);
+    const ParseSession::IdList userIds = session.parse(userText);
+    const ParseSession::IdList mirrorIds = session.parse(mirrorText);
+    const ParseSession::Diff diff = session.diff(userIds, mirrorIds);
+    return exportMissingPermissions(path, format, assigneeId, qsizetype(diff.missing.size()),
+                                    [&](qsizetype i) { return session.name(diff.missing[size_t(i)]).toString(); },
+                                    session.catalog());
+}
+
+// Who holds which permission sets, imported from a PermissionSetAssignment export:
+//
+//   SELECT AssigneeId, Assignee.Username, PermissionSetId, PermissionSet.Name
+//   FROM PermissionSetAssignment
+//
+// Columns are located by header name, so extra or reordered columns are fine.
+struct AssignmentIndex {
+    QHash<QString, QString> assigneeIds;        // lower-cased username or 15-char user Id -> AssigneeId
+    QHash<QString, QSet<QString>> assignments;  // AssigneeId -> PermissionSetIds
+    QHash<QString, QString> permissionSetNames; // PermissionSetId -> API name
+    qint64 rows = 0;
+
+    // Salesforce Ids are case-sensitive and may be given in 15- or 18-character form.
+    static bool looksLikeUserId(const QString &value) {
+        return (value.size() == 15 || value.size() == 18) && value.startsWith("005");
+    }
+
+    // Usernames must appear in the export. A user Id that does not is still accepted,
+    // since new hires typically have no assignments yet.
+    QString resolveUser(const QString &user) const {
+        const QString trimmed = user.trimmed();
+        if (looksLikeUserId(trimmed)) return assigneeIds.value(trimmed.left(15), trimmed);
+        return assigneeIds.value(trimmed.toLower());
+    }
+};
+using AssignmentSnapshot = std::shared_ptr<const AssignmentIndex>;
+
+struct AssignmentImport {
+    AssignmentSnapshot index;
+    QString error;
+};
+
+static AssignmentImport importAssignments(const QString &path) {
+    AssignmentImport result;
+    QString text;
+    if (!readTextFile(path, text, &result.error)) return result;
+
+    const qsizetype headerEnd = text.indexOf(u'\n');
+    const QStringList header = splitCsvLine(QStringView(text).left(headerEnd).trimmed());
+    auto column = [&header](const char *name) {
+        for (int i = 0; i < header.size(); ++i) {
+            if (header[i].trimmed().compare(QLatin1String(name), Qt::CaseInsensitive) == 0) return i;
+        }
+        return -1;
+    };
+    const int assigneeCol = column("AssigneeId");
+    const int usernameCol = column("Assignee.Username");
+    const int permSetCol = column("PermissionSetId");
+    const int permSetNameCol = column("PermissionSet.Name");
+    if (assigneeCol < 0 || permSetCol < 0) {
+        result.error = "The file needs AssigneeId and PermissionSetId columns.";
+        return result;
+    }
+
+    auto index = std::make_shared<AssignmentIndex>();
+    forEachLine(QStringView(text).sliced(headerEnd < 0 ? text.size() : headerEnd + 1), [&](QStringView line) {
+        const QStringList parts = splitCsvLine(line);
+        const QString assignee = parts.value(assigneeCol).trimmed();
+        const QString permSet = parts.value(permSetCol).trimmed();
+        if (assignee.isEmpty() || permSet.isEmpty()) return;
+
+        index->assignments[assignee].insert(permSet);
+        index->assigneeIds.insert(assignee.left(15), assignee);
+        const QString username = parts.value(usernameCol).trimmed();
+        if (!username.isEmpty()) index->assigneeIds.insert(username.toLower(), assignee);
+        const QString permSetName = parts.value(permSetNameCol).trimmed();
+        if (!permSetName.isEmpty()) index->permissionSetNames.insert(permSet, permSetName);
+        ++index->rows;
+    });
+    result.index = std::move(index);
+    return result;
+}
+
+// The Bulk API caps a batch at 10,000 records, so plans are split into files of that size.
+static const int DATA_LOADER_BATCH_ROWS = 10000;
+
+struct BatchPlanSummary {
+    qint64 pairs = 0;
+    qint64 rows = 0;
+    int files = 0;
+    QStringList unresolved;
+    QString error;
+};
+
+// Resolves every (new user, mirror user) pair of the manifest against the assignment
+// index, computes the missing assignments in parallel, and writes the de-duplicated,
+// sorted rows as Data Loader insert files of at most DATA_LOADER_BATCH_ROWS rows:
+// <output>_001.csv, <output>_002.csv, ...
+//
+// The manifest is a CSV with a header row followed by one "new user,mirror user" pair
+// per line; either side may be a username or a user Id.
+static BatchPlanSummary generateBatchPlan(const QString &manifestPath, const QString &outputPath,
+                                          const AssignmentSnapshot &index) {
+    BatchPlanSummary summary;
+    QString manifest;
+    if (!readTextFile(manifestPath, manifest, &summary.error)) return summary;
+
+    struct Pair {
+        QString newUser;
+        QString mirrorUser;
+    };
+    std::vector<Pair> pairs;
+    bool header = true;
+    forEachLine(manifest, [&pairs, &header](QStringView line) {
+        // Skip header
+        if (header) {
+            header = false;
+            return;
+        }
+        const QStringList parts = splitCsvLine(line);
+        if (parts.size() < 2 || parts[0].trimmed().isEmpty()) return;
+        pairs.push_back(Pair{ parts[0].trimmed(), parts[1].trimmed() });
+    });
+    summary.pairs = qint64(pairs.size());
+
+    using Row = std::pair<QString, QString>; // AssigneeId, PermissionSetId
+    struct PairRows {
+        std::vector<Row> rows;
+        QString unresolved;
+    };
+    // Runs on a worker itself, which helps with the pairs while it waits.
+    const QList<PairRows> planned = JobScheduler::instance().blockingMapped(JobPriority::Normal,
+        pairs, [&index](const Pair &pair) {
+            PairRows out;
+            const QString assignee = index->resolveUser(pair.newUser);
+            const auto mirrorSets = index->assignments.constFind(index->resolveUser(pair.mirrorUser));
+            if (assignee.isEmpty() || mirrorSets == index->assignments.cend()) {
+                out.unresolved = assignee.isEmpty() ? pair.newUser : pair.mirrorUser;
+                return out;
+            }
+            const QSet<QString> userSets = index->assignments.value(assignee);
+            for (const QString &permSet : *mirrorSets) {
+                if (!userSets.contains(permSet)) out.rows.emplace_back(assignee, permSet);
+            }
+            return out;
+        });
+
+    std::vector<Row> rows;
+    for (const PairRows &p : planned) {
+        if (!p.unresolved.isEmpty()) summary.unresolved << p.unresolved;
+        rows.insert(rows.end(), p.rows.begin(), p.rows.end());
+    }
+    // A user listed twice, or with two mirrors, must not be assigned the same set twice.
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    summary.rows = qint64(rows.size());
+
+    const QFileInfo output(outputPath);
+    const QString stem = output.dir().filePath(output.completeBaseName());
+    for (size_t start = 0; start < rows.size(); start += DATA_LOADER_BATCH_ROWS) {
+        const size_t end = std::min(rows.size(), start + DATA_LOADER_BATCH_ROWS);
+        QSaveFile file(QString("%1_%2.csv").arg(stem).arg(summary.files + 1, 3, 10, QChar('0')));
+        if (!file.open(QIODevice::WriteOnly)) {
+            summary.error = file.errorString();
+            return summary;
+        }
+        ResultExporter exporter(&file, ExportFormat::DataLoader, true);
+        bool ok = exporter.writeHeader();
+        for (size_t i = start; ok && i < end; ++i) {
+            ExportRow row;
+            row.assigneeId = rows[i].first;
+            row.permissionSetId = rows[i].second;
+            ok = exporter.writeRow(row);
+        }
+        ok = ok && exporter.finish();
+        if (!ok || !file.commit()) {
+            summary.error = exporter.result().error.isEmpty() ? file.errorString() : exporter.result().error;
+            return summary;
+        }
+        ++summary.files;
+    }
+    return summary;
 }
 
-static QStringList extractPermissionNames(const QString &raw) {
-    QStringList lines = raw.split('\n');
-    QStringList names;
-    QSet<QString> seen;
-    for (const QString &l : lines) {
-        QString candidate = extractPermissionName(l);
-        if (!candidate.isEmpty() && !seen.contains(candidate)) {
-            names << candidate;
-            seen.insert(candidate);
+// Rows of a multi-file comparison: (file, missing permission set). Descriptions are
+// looked up when a row is displayed, so only visible rows ever touch the catalog.
+class BatchResultModel : public QAbstractTableModel {
+public:
+    using QAbstractTableModel::QAbstractTableModel;
+
+    void reset(const CatalogSnapshot &descriptions) {
+        beginResetModel();
+        catalog = descriptions;
+        files.clear();
+        rows.clear();
+        endResetModel();
+    }
+
+    void appendFile(const QString &file, const QStringList &missing) {
+        if (missing.isEmpty()) return;
+        const int fileIndex = files.size();
+        files << QFileInfo(file).fileName();
+        const int first = int(rows.size());
+        beginInsertRows(QModelIndex(), first, first + int(missing.size()) - 1);
+        for (const QString &perm : missing) rows.push_back(Row{ fileIndex, perm });
+        endInsertRows();
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : int(rows.size());
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : 3;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override {
+        if (!index.isValid() || role != Qt::DisplayRole) return QVariant();
+        const Row &row = rows[size_t(index.row())];
+        switch (index.column()) {
+        case 0: return files[row.file];
+        case 1: return row.permissionSet;
+        default: return catalog ? catalog->descriptionFor(row.permissionSet) : QString();
+        }
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+        static const char *const headers[] = { "File", "Permission Set", "Description" };
+        return QString(headers[section]);
+    }
+
+private:
+    struct Row {
+        int file;
+        QString permissionSet;
+    };
+    QStringList files;
+    std::vector<Row> rows;
+    CatalogSnapshot catalog;
+};
+
+// The three sections of an interactive comparison, each a heading row followed by
+// its permission sets. Rows hold interned ids of the session that produced them;
+// names and descriptions are resolved only for the rows the view paints.
+class ComparisonResultModel : public QAbstractTableModel {
+public:
+    enum Section { Missing, Extra, Shared, SectionCount };
+
+    using QAbstractTableModel::QAbstractTableModel;
+
+    // `session` must outlive the results and must not be reset while they are shown.
+    void setResults(const ParseSession *session, ParseSession::Diff diff) {
+        beginResetModel();
+        source = session;
+        catalog = session->catalog();
+        // Emplaced rather than assigned so the lists keep their arena allocator.
+        results.emplace(std::move(diff));
+        endResetModel();
+    }
+
+    void clear() {
+        beginResetModel();
+        source = nullptr;
+        results.reset();
+        endResetModel();
+    }
+
+    void setCatalog(const CatalogSnapshot &descriptions) {
+        catalog = descriptions;
+        if (rowCount() > 0) emit dataChanged(index(0, 1), index(rowCount() - 1, 1), { Qt::DisplayRole, Qt::ToolTipRole });
+    }
+
+    const ParseSession::IdList &ids(int section) const {
+        return section == Missing ? results->missing : section == Extra ? results->extra : results->shared;
+    }
+
+    // Heading rows, which the view spans across both columns.
+    QList<int> headingRows() const {
+        QList<int> rows;
+        if (!source) return rows;
+        int row = 0;
+        for (int s = 0; s < SectionCount; ++s) {
+            rows << row;
+            row += 1 + sectionRows(s);
+        }
+        return rows;
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+        if (parent.isValid() || !source) return 0;
+        int rows = 0;
+        for (int s = 0; s < SectionCount; ++s) rows += 1 + sectionRows(s);
+        return rows;
+    }
+
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : 2;
+    }
+
+    QVariant data(const QModelIndex &index, int role) const override {
+        if (!index.isValid() || !source) return QVariant();
+        const auto [section, offset] = locate(index.row());
+
+        if (offset < 0) {
+            static const char *const titles[] = {
+                "Missing: mirror has, user needs (%1)",
+                "Extra: user has, mirror lacks (%1)",
+                "Shared (%1)",
+            };
+            switch (role) {
+            case Qt::DisplayRole:
+                return index.column() == 0 ? QString(titles[section]).arg(ids(section).size()) : QVariant();
+            case Qt::FontRole: {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            case Qt::BackgroundRole: return QBrush(QColor("#f0f2f5"));
+            case Qt::ForegroundRole: return QBrush(QColor("#4b4f56"));
+            default: return QVariant();
+            }
+        }
+
+        if (ids(section).empty()) {
+            if (role != Qt::DisplayRole || index.column() != 0) return QVariant();
+            static const char *const empty[] = {
+                "No missing permissions.",
+                "No extra permissions.",
+                "No permission sets in common.",
+            };
+            return QString(empty[section]);
+        }
+
+        const QStringView name = source->name(ids(section)[size_t(offset)]);
+        if (index.column() == 0) {
+            switch (role) {
+            case Qt::DisplayRole: return name.toString();
+            case Qt::FontRole: {
+                QFont font;
+                font.setBold(section != Shared);
+                return font;
+            }
+            case Qt::ForegroundRole: {
+                static const char *const colors[] = { "#c53030", "#b7791f", "#1c1e21" };
+                return QBrush(QColor(colors[section]));
+            }
+            default: return QVariant();
+            }
+        }
+        switch (role) {
+        case Qt::DisplayRole:
+        case Qt::ToolTipRole:
+            return catalog ? catalog->descriptionFor(name.toString()) : QString();
+        case Qt::ForegroundRole: return QBrush(QColor("#4b4f56"));
+        default: return QVariant();
+        }
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+        return section == 0 ? QString("Permission Set") : QString("Description");
+    }
+
+private:
+    // An empty section still shows one "none" row.
+    int sectionRows(int section) const {
+        return std::max(1, int(ids(section).size()));
+    }
+
+    // Section and position within it of a row; -1 is the section's heading.
+    std::pair<int, int> locate(int row) const {
+        for (int s = 0; s < SectionCount; ++s) {
+            const int span = 1 + sectionRows(s);
+            if (row < span) return { s, row - 1 };
+            row -= span;
         }
+        return { Shared, sectionRows(Shared) - 1 };
     }
-    return names;
+
+    const ParseSession *source = nullptr;
+    CatalogSnapshot catalog;
+    std::optional<ParseSession::Diff> results;
+};
+
+struct WatchJobResult {
+    QString path;
+    qint64 missing = 0;
+    QString error;
+};
+
+static QString watchOutputSuffix() { return QStringLiteral(".missing.csv"); }
+
+static QString watchOutputPath(const QString &inputPath, const QString &outputDir) {
+    return QDir(outputDir).filePath(QFileInfo(inputPath).completeBaseName() + watchOutputSuffix());
 }
 
-static QSet<QString> parsePermissions(const QString &raw) {
-    const QStringList names = extractPermissionNames(raw);
-    return QSet<QString>(names.cbegin(), names.cend());
+// Compares one arrived export against the mirror set and writes its missing
+// permission sets next to the others in the output folder.
+static WatchJobResult processWatchedFile(const QString &path, const QString &outputDir,
+                                         const QSet<QString> &mirrorPerms, const CatalogSnapshot &catalog) {
+    WatchJobResult result;
+    result.path = path;
+    const ParsedFile parsed = readPermissionFile(path);
+    if (!parsed.error.isEmpty()) {
+        result.error = parsed.error;
+        return result;
+    }
+    const QStringList missing = missingPermissions(QSet<QString>(parsed.names.cbegin(), parsed.names.cend()), mirrorPerms);
+    const ExportSummary summary = exportMissingPermissions(watchOutputPath(path, outputDir), ExportFormat::Csv,
+                                                           QString(), missing, catalog);
+    result.missing = summary.rows;
+    result.error = summary.error;
+    return result;
 }
 
-class PermissionInputArea : public QPlainTextEdit {
+// Watches a folder for user export files and compares each against a fixed mirror
+// set once it has stopped growing. A file counts as stable when its size and
+// modification time are unchanged across two polls. Stable files wait in a bounded
+// queue; at most one job per core is in flight, and candidates stay unqueued while
+// the queue is full. A file is skipped when its output is already newer than it.
+class WatchFolderPipeline : public QObject {
     Q_OBJECT
 public:
-    explicit PermissionInputArea(const QString &placeholder, QWidget *parent = nullptr)
-        : QPlainTextEdit(parent) {
-        setPlaceholderText(placeholder);
-        setLineWrapMode(QPlainTextEdit::NoWrap);
-        connect(this, &QPlainTextEdit::textChanged, this, &PermissionInputArea::sanitizeText);
+    struct Metrics {
+        qint64 processed = 0;
+        qint64 failed = 0;
+        int waiting = 0; // seen but not yet stable
+        int queued = 0;
+        int running = 0;
+        double filesPerSecond = 0;
+    };
+
+    WatchFolderPipeline(const QString &inputDir, const QString &outputDir, const QSet<QString> &mirrorPerms,
+                        const CatalogSnapshot &catalog, QObject *parent = nullptr)
+        : QObject(parent), inputDir(inputDir), outputDir(outputDir), mirrorPerms(mirrorPerms), catalog(catalog) {
+        maxRunning = qMax(1, QThread::idealThreadCount());
+        watcher = new QFileSystemWatcher(QStringList{ inputDir }, this);
+        connect(watcher, &QFileSystemWatcher::directoryChanged, this, &WatchFolderPipeline::scan);
+        pollTimer = new QTimer(this);
+        pollTimer->setInterval(500);
+        connect(pollTimer, &QTimer::timeout, this, &WatchFolderPipeline::poll);
+        pollTimer->start();
+        clock.start();
+        scan();
     }
 
+    Metrics metrics() const { return current; }
+
+signals:
+    void metricsChanged();
+    void fileFailed(const QString &path, const QString &error);
+
 private slots:
-    void sanitizeText() {
-        QString text = toPlainText();
-        QStringList sanitizedLines = extractPermissionNames(text);
-        QString sanitized = sanitizedLines.join('\n');
-        if (text == sanitized) return;
-        QSignalBlocker blocker(this); // RAII blocks signals
-        setPlainText(sanitized);
-        QTextCursor c = textCursor();
-        c.movePosition(QTextCursor::End);
-        setTextCursor(c);
+    void scan() {
+        const QFileInfoList files = QDir(inputDir).entryInfoList(QDir::Files | QDir::Readable, QDir::Time | QDir::Reversed);
+        for (const QFileInfo &info : files) {
+            const QString path = info.absoluteFilePath();
+            if (path.endsWith(watchOutputSuffix()) || candidates.contains(path) || active.contains(path)) continue;
+            const QFileInfo output(watchOutputPath(path, outputDir));
+            if (output.exists() && output.lastModified() >= info.lastModified()) continue;
+            candidates.insert(path, Candidate{ info.size(), info.lastModified(), false });
+        }
+        publish();
     }
-};
 
-static QString resourcePath(const QString &name) {
-    // Resolve relative to application dir.
-    QDir base(QCoreApplication::applicationDirPath());
-    return base.filePath(name);
-}
+    void poll() {
+        for (auto it = candidates.begin(); it != candidates.end();) {
+            if (queue.size() >= QueueCapacity) break;
+            const QFileInfo info(it.key());
+            if (!info.exists()) {
+                it = candidates.erase(it);
+                continue;
+            }
+            Candidate &c = it.value();
+            const bool unchanged = info.size() == c.size && info.lastModified() == c.modified;
+            c.size = info.size();
+            c.modified = info.lastModified();
+            if (!unchanged || !c.seenUnchanged) {
+                c.seenUnchanged = unchanged;
+                ++it;
+                continue;
+            }
+            queue.enqueue(it.key());
+            active.insert(it.key());
+            it = candidates.erase(it);
+        }
+        dispatch();
+        publish();
+    }
+
+private:
+    struct Candidate {
+        qint64 size;
+        QDateTime modified;
+        bool seenUnchanged;
+    };
+
+    static constexpr int QueueCapacity = 256;
+
+    QString inputDir;
+    QString outputDir;
+    QSet<QString> mirrorPerms;
+    CatalogSnapshot catalog;
+    QFileSystemWatcher *watcher{nullptr};
+    QTimer *pollTimer{nullptr};
+    QHash<QString, Candidate> candidates;
+    QQueue<QString> queue;
+    QSet<QString> active; // queued or running
+    int running{0};
+    int maxRunning{1};
+    QElapsedTimer clock;
+    QQueue<qint64> completions; // ms timestamps within the throughput window
+    Metrics current;
+
+    void dispatch() {
+        while (running < maxRunning && !queue.isEmpty()) {
+            const QString path = queue.dequeue();
+            ++running;
+            JobScheduler::instance()
+                .run(JobPriority::Background, [path, outputDir = outputDir, mirrorPerms = mirrorPerms, catalog = catalog] {
+                    return processWatchedFile(path, outputDir, mirrorPerms, catalog);
+                })
+                .then(this, [this](const WatchJobResult &result) { finishJob(result); });
+        }
+    }
+
+    void finishJob(const WatchJobResult &result) {
+        --running;
+        active.remove(result.path);
+        if (result.error.isEmpty()) {
+            ++current.processed;
+        } else {
+            ++current.failed;
+            emit fileFailed(result.path, result.error);
+        }
+        completions.enqueue(clock.elapsed());
+        dispatch();
+        publish();
+    }
+
+    void publish() {
+        const qint64 now = clock.elapsed();
+        const qint64 window = 5000;
+        while (!completions.isEmpty() && completions.head() < now - window) completions.dequeue();
+        current.waiting = candidates.size();
+        current.queued = queue.size();
+        current.running = running;
+        current.filesPerSecond = completions.size() * 1000.0 / qMin(now + 1, window);
+        emit metricsChanged();
+    }
+};
 
 class PermissionSetCalculator : public QMainWindow {
     Q_OBJECT
 public:
     PermissionSetCalculator() {
         setWindowTitle("Permission Set Comparator");
-        // Prefer ICO then PNG
-        const QStringList icons{ "Salesforce_perm_Calc_icon.ico", "Salesforce_perm_Calc_icon.png" };
-        for (const QString &ic : icons) {
-            QString p = resourcePath(ic);
-            if (QFileInfo::exists(p)) { setWindowIcon(QIcon(p)); break; }
-        }
+        // The window icon comes from the application; see appIcon().
         resize(900, 800);
-        loadDescriptionsFromCsv();
+        setAcceptDrops(true);
+        loadOrgConfig(catalogs);
+        loadParsingConfig();
+        loadRoleTemplates();
+        activeOrg = catalogs.orgs().first();
         buildUi();
+        buildMenus();
+        markStartup("build_ui");
         applyStyles();
+        markStartup("apply_styles");
+        watchCatalog();
     }
 
 private:
-    PermissionInputArea *userInput{nullptr};
-    PermissionInputArea *mirrorInput{nullptr};
-    QTableWidget *outputArea{nullptr};
+    PermissionInputPane *userInput{nullptr};
+    PermissionInputPane *mirrorInput{nullptr};
+    QTableView *outputArea{nullptr};
+    QLabel *descriptionDetail{nullptr};
+    ComparisonResultModel *comparison{nullptr};
     QPushButton *compareButton{nullptr};
-    QMap<QString, QString> permDescriptions;
+    QPushButton *exportButton{nullptr};
+    QFutureWatcher<ExportSummary> *exportWatcher{nullptr};
+    AssignmentSnapshot assignments;
+    QFutureWatcher<AssignmentImport> *assignmentWatcher{nullptr};
+    QFutureWatcher<BatchPlanSummary> *batchPlanWatcher{nullptr};
+    QAction *batchPlanAction{nullptr};
+    RoleTemplateLibrary roleTemplates;
+    QString roleTemplateFile;
+    QMenu *useTemplateMenu{nullptr};
+    QMenu *deleteTemplateMenu{nullptr};
+    QAction *bestFitAction{nullptr};
+    QGroupBox *mirrorGroup{nullptr};
+    QProgressBar *dropProgress{nullptr};
+    QPushButton *dropCancelButton{nullptr};
+    QFutureWatcher<ParsedFile> *dropWatcher{nullptr};
+    WatchFolderPipeline *watchPipeline{nullptr};
+    QLabel *watchStatus{nullptr};
+    QAction *watchStartAction{nullptr};
+    QAction *watchStopAction{nullptr};
+    bool dropIsMirror{false};
+    QSet<QString> droppedMirrorPerms;
+    BatchResultModel *batchResults{nullptr};
+    QTableView *batchResultsView{nullptr};
+    QComboBox *orgSelector{nullptr};
+    CatalogRegistry catalogs;
+    ParseSession compareSession;
+    QString activeOrg;
+    QString resultsOrg;
+    QFileSystemWatcher *catalogWatcher{nullptr};
+    QTimer *catalogReloadTimer{nullptr};
+    QFutureWatcher<CatalogReload> *catalogReloadWatcher{nullptr};
+    QString reloadingOrg;
+    QDateTime watchedModified;
+    bool catalogReloadPending{false};
+    bool painted{false};
 
-    void loadDescriptionsFromCsv() {
-        QString path = resourcePath("Permission Sets.csv");
-        QFile file(path);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+    CatalogSnapshot currentCatalog() { return catalogs.acquire(activeOrg); }
 
-        QTextStream in(&file);
-        // Skip header
-        if (!in.atEnd()) in.readLine();
-
-        while (!in.atEnd()) {
-            QString line = in.readLine();
-            QStringList parts;
-            QString current;
-            bool inQuote = false;
-            for (int i = 0; i < line.length(); ++i) {
-                QChar c = line[i];
-                if (c == '"') {
-                    inQuote = !inQuote;
-                } else if (c == ',' && !inQuote) {
-                    parts << current;
-                    current.clear();
-                } else {
-                    current += c;
-                }
-            }
-            parts << current;
-
-            if (parts.size() >= 4) {
-                QString name = parts[2].trimmed();
-                QString desc = parts[3].trimmed();
-                if (desc.startsWith('"') && desc.endsWith('"')) {
-                    desc = desc.mid(1, desc.length() - 2);
-                    desc.replace("\"\"", "\"");
-                }
-                if (!name.isEmpty()) {
-                    permDescriptions.insert(name.toLower(), desc);
-                }
-            }
-        }
-        file.close();
+    void watchCatalog() {
+        catalogWatcher = new QFileSystemWatcher(this);
+        retargetCatalogWatcher();
+
+        // Coalesce the burst of notifications a single save produces.
+        catalogReloadTimer = new QTimer(this);
+        catalogReloadTimer->setSingleShot(true);
+        catalogReloadTimer->setInterval(250);
+        connect(catalogWatcher, &QFileSystemWatcher::fileChanged, catalogReloadTimer, qOverload<>(&QTimer::start));
+        connect(catalogWatcher, &QFileSystemWatcher::directoryChanged, catalogReloadTimer, qOverload<>(&QTimer::start));
+        connect(catalogReloadTimer, &QTimer::timeout, this, &PermissionSetCalculator::startCatalogReload);
+
+        catalogReloadWatcher = new QFutureWatcher<CatalogReload>(this);
+        connect(catalogReloadWatcher, &QFutureWatcher<CatalogReload>::finished, this, &PermissionSetCalculator::finishCatalogReload);
+    }
+
+    // Only the active org's catalog is watched. Editors often save by replacing the
+    // file, which drops it from the watch list, so its directory is watched as well.
+    void retargetCatalogWatcher() {
+        if (!catalogWatcher->files().isEmpty()) catalogWatcher->removePaths(catalogWatcher->files());
+        if (!catalogWatcher->directories().isEmpty()) catalogWatcher->removePaths(catalogWatcher->directories());
+        const QString path = catalogs.pathFor(activeOrg);
+        catalogWatcher->addPath(QFileInfo(path).absolutePath());
+        if (QFileInfo::exists(path)) catalogWatcher->addPath(path);
+        watchedModified = QFileInfo(path).lastModified();
+    }
+
+    void buildMenus() {
+        QMenu *batchMenu = menuBar()->addMenu("&Batch");
+        batchMenu->addAction("&Import Assignments...", this, &PermissionSetCalculator::importAssignmentFile);
+        batchPlanAction = batchMenu->addAction("&Generate Provisioning Plan...", this, &PermissionSetCalculator::generateProvisioningPlan);
+        batchPlanAction->setEnabled(false);
+
+        QMenu *templateMenu = menuBar()->addMenu("&Templates");
+        templateMenu->addAction("&Save Mirror User as Template...", this, &PermissionSetCalculator::saveMirrorAsTemplate);
+        useTemplateMenu = templateMenu->addMenu("&Use as Mirror User");
+        bestFitAction = templateMenu->addAction("&Find Best Fit for Primary User...", this, &PermissionSetCalculator::findBestTemplate);
+        templateMenu->addSeparator();
+        deleteTemplateMenu = templateMenu->addMenu("&Delete Template");
+        refreshTemplateMenus();
+
+        QMenu *watchMenu = menuBar()->addMenu("&Watch");
+        watchStartAction = watchMenu->addAction("&Start Watch Folder...", this, &PermissionSetCalculator::startWatchFolder);
+        watchStopAction = watchMenu->addAction("S&top Watch Folder", this, &PermissionSetCalculator::stopWatchFolder);
+        watchStopAction->setEnabled(false);
+        watchStatus = new QLabel;
+        statusBar()->addPermanentWidget(watchStatus);
+        watchStatus->hide();
+
+        assignmentWatcher = new QFutureWatcher<AssignmentImport>(this);
+        connect(assignmentWatcher, &QFutureWatcher<AssignmentImport>::finished, this, &PermissionSetCalculator::finishAssignmentImport);
+        batchPlanWatcher = new QFutureWatcher<BatchPlanSummary>(this);
+        connect(batchPlanWatcher, &QFutureWatcher<BatchPlanSummary>::finished, this, &PermissionSetCalculator::finishProvisioningPlan);
+
+        dropProgress = new QProgressBar;
+        dropProgress->setMaximumWidth(240);
+        dropCancelButton = new QPushButton("Cancel");
+        statusBar()->addPermanentWidget(dropProgress);
+        statusBar()->addPermanentWidget(dropCancelButton);
+        dropProgress->hide();
+        dropCancelButton->hide();
+
+        dropWatcher = new QFutureWatcher<ParsedFile>(this);
+        connect(dropWatcher, &QFutureWatcher<ParsedFile>::progressRangeChanged, dropProgress, &QProgressBar::setRange);
+        connect(dropWatcher, &QFutureWatcher<ParsedFile>::progressValueChanged, dropProgress, &QProgressBar::setValue);
+        connect(dropWatcher, &QFutureWatcher<ParsedFile>::resultReadyAt, this, &PermissionSetCalculator::collectDroppedFile);
+        connect(dropWatcher, &QFutureWatcher<ParsedFile>::finished, this, &PermissionSetCalculator::finishDroppedFiles);
+        connect(dropCancelButton, &QPushButton::clicked, dropWatcher, &QFutureWatcher<ParsedFile>::cancel);
     }
 
     void buildUi() {
@@ -226,11 +1773,26 @@ private:
         header->setAlignment(Qt::AlignCenter);
         mainLayout->addWidget(header);
 
+        orgSelector = new QComboBox;
+        orgSelector->addItems(catalogs.orgs());
+        connect(orgSelector, &QComboBox::currentTextChanged, this, &PermissionSetCalculator::switchOrg);
+        QLabel *orgLabel = new QLabel("Org:");
+        QHBoxLayout *orgLayout = new QHBoxLayout;
+        orgLayout->addStretch();
+        orgLayout->addWidget(orgLabel);
+        orgLayout->addWidget(orgSelector);
+        mainLayout->addLayout(orgLayout);
+        // A single configured catalog needs no picker.
+        if (catalogs.orgs().size() < 2) {
+            orgLabel->hide();
+            orgSelector->hide();
+        }
+
         QHBoxLayout *inputsLayout = new QHBoxLayout;
         inputsLayout->setSpacing(24);
         mainLayout->addLayout(inputsLayout);
 
-        userInput = new PermissionInputArea("Paste primary user's permissions here...");
+        userInput = new PermissionInputPane("Paste primary user's permissions here...", PermissionHighlighter::Side::Primary);
         QGroupBox *userGroup = new QGroupBox("Primary User");
         QVBoxLayout *userGroupLayout = new QVBoxLayout;
         userGroupLayout->setContentsMargins(16, 24, 16, 16);
@@ -238,194 +1800,575 @@ private:
         userGroup->setLayout(userGroupLayout);
         inputsLayout->addWidget(userGroup);
 
-        mirrorInput = new PermissionInputArea("Paste mirror user's permissions here...");
-        QGroupBox *mirrorGroup = new QGroupBox("Mirror User");
+        mirrorInput = new PermissionInputPane("Paste mirror user's permissions here...", PermissionHighlighter::Side::Mirror);
+        mirrorGroup = new QGroupBox("Mirror User");
         QVBoxLayout *mirrorGroupLayout = new QVBoxLayout;
         mirrorGroupLayout->setContentsMargins(16, 24, 16, 16);
         mirrorGroupLayout->addWidget(mirrorInput);
         mirrorGroup->setLayout(mirrorGroupLayout);
         inputsLayout->addWidget(mirrorGroup);
 
+        userInput->highlighter()->setCounterpart(mirrorInput->highlighter());
+        mirrorInput->highlighter()->setCounterpart(userInput->highlighter());
+        // The catalog for the unknown-name check is loaded once the window is up.
+        QTimer::singleShot(0, this, &PermissionSetCalculator::updateLineStatusCatalog);
+
         compareButton = new QPushButton("Compare Permissions");
         compareButton->setCursor(Qt::PointingHandCursor);
         compareButton->setFixedHeight(50);
         connect(compareButton, &QPushButton::clicked, this, &PermissionSetCalculator::comparePermissions);
-        mainLayout->addWidget(compareButton);
 
-        QGroupBox *outputGroup = new QGroupBox("Missing Permissions (Mirror has, User needs)");
+        exportButton = new QPushButton("Export...");
+        exportButton->setObjectName("SecondaryButton");
+        exportButton->setCursor(Qt::PointingHandCursor);
+        exportButton->setFixedHeight(50);
+        connect(exportButton, &QPushButton::clicked, this, &PermissionSetCalculator::exportResults);
+
+        QHBoxLayout *actionsLayout = new QHBoxLayout;
+        actionsLayout->setSpacing(12);
+        actionsLayout->addWidget(compareButton, 1);
+        actionsLayout->addWidget(exportButton);
+        mainLayout->addLayout(actionsLayout);
+
+        QGroupBox *outputGroup = new QGroupBox("Comparison (Missing / Extra / Shared)");
         QVBoxLayout *outputGroupLayout = new QVBoxLayout;
         outputGroupLayout->setContentsMargins(16, 24, 16, 16);
-        
-        outputArea = new QTableWidget;
+
+        comparison = new ComparisonResultModel(this);
+        outputArea = new QTableView;
+        outputArea->setModel(comparison);
         outputArea->setMinimumHeight(300);
-        outputArea->setColumnCount(2);
-        outputArea->setHorizontalHeaderLabels({"Permission Set", "Description"});
         outputArea->verticalHeader()->setVisible(false);
+        // Fixed row heights keep scrolling independent of the row count. Full
+        // descriptions are in the tooltips, and below the table for a clicked row.
+        outputArea->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+        outputArea->verticalHeader()->setDefaultSectionSize(ResultRowDelegate::RowHeight);
+        outputArea->setItemDelegate(new ResultRowDelegate(outputArea));
         outputArea->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
         outputArea->horizontalHeader()->setDefaultAlignment(Qt::AlignCenter);
         outputArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
-        outputArea->setWordWrap(true);
+        outputArea->setWordWrap(false);
         outputArea->setShowGrid(false);
         outputArea->setSelectionBehavior(QAbstractItemView::SelectRows);
         outputArea->setEditTriggers(QAbstractItemView::NoEditTriggers);
         outputArea->setAlternatingRowColors(true);
         outputArea->setFocusPolicy(Qt::NoFocus);
         outputArea->setSelectionMode(QAbstractItemView::NoSelection);
-        
+
+        descriptionDetail = new QLabel;
+        descriptionDetail->setWordWrap(true);
+        descriptionDetail->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        descriptionDetail->hide();
+        connect(outputArea, &QTableView::clicked, this, &PermissionSetCalculator::showDescription);
+
         outputGroupLayout->addWidget(outputArea);
+        outputGroupLayout->addWidget(descriptionDetail);
         outputGroup->setLayout(outputGroupLayout);
         mainLayout->addWidget(outputGroup);
     }
 
+    // The theme is application-wide so that dialogs and the batch window match.
     void applyStyles() {
-        setStyleSheet(R"(
-            QMainWindow {
-                background-color: #f0f2f5;
-            }
-            QWidget {
-                font-family: "Segoe UI", sans-serif;
-                font-size: 14px;
-                color: #1c1e21;
-            }
-            QLabel#HeaderLabel {
-                font-size: 28px;
-                font-weight: 700;
-                color: #1c1e21;
-                margin-bottom: 10px;
-            }
-            QGroupBox {
-                background-color: #ffffff;
-                border: 1px solid #dddfe2;
-                border-radius: 8px;
-                margin-top: 24px;
-                font-size: 14px;
-                font-weight: 600;
-                color: #4b4f56;
-            }
-            QGroupBox::title {
-                subcontrol-origin: margin;
-                subcontrol-position: top left;
-                left: 12px;
-                padding: 0 8px;
-            }
-            QPlainTextEdit {
-                border: 1px solid #ccd0d5;
-                border-radius: 6px;
-                padding: 10px;
-                background-color: #f5f6f7;
-                font-family: "Consolas", "Courier New", monospace;
-                font-size: 13px;
-            }
-            QPlainTextEdit:focus {
-                background-color: #ffffff;
-                border: 1px solid #1877f2;
-            }
-            QPushButton {
-                background-color: #1877f2;
-                color: #ffffff;
-                border: none;
-                border-radius: 6px;
-                font-size: 16px;
-                font-weight: 600;
-                padding: 12px;
-            }
-            QPushButton:hover {
-                background-color: #166fe5;
-            }
-            QPushButton:pressed {
-                background-color: #155db5;
-            }
-            QTableWidget {
-                border: 1px solid #ccd0d5;
-                border-radius: 6px;
-                background-color: #ffffff;
-                alternate-background-color: #f9fafb;
-                font-family: "Segoe UI", sans-serif;
-                font-size: 13px;
-                color: #1c1e21;
-                outline: none;
-            }
-            QHeaderView::section {
-                background-color: #f0f2f5;
-                padding: 8px;
-                border: none;
-                border-bottom: 1px solid #dddfe2;
-                font-weight: 600;
-                color: #4b4f56;
-            }
-            QTableWidget::item {
-                padding: 8px;
-                border-bottom: 1px solid #f0f2f5;
-            }
-        )");
+        applyPermCalcTheme(*qApp);
+    }
+
+public:
+    // See comparePermissionTexts().
+    void compareTexts(const QString &userText, const QString &mirrorText) {
+        StageScope stage("comparePermissions", { { "user chars", userText.size() }, { "mirror chars", mirrorText.size() } });
+        const CatalogSnapshot descriptions = currentCatalog();
+        resultsOrg = activeOrg;
+        // The model points into the session, so it lets go before the arena is released.
+        comparison->clear();
+        descriptionDetail->hide();
+        outputArea->clearSpans();
+        // Releases everything the previous compare allocated in one step.
+        compareSession.reset(descriptions);
+        const ParseSession::IdList userIds = compareSession.parse(userText);
+        const ParseSession::IdList mirrorIds = compareSession.parse(mirrorText);
+        // Missing (mirror - user), extra (user - mirror) and shared from one pass.
+        ParseSession::Diff diff = compareSession.diff(userIds, mirrorIds);
+        StageScope population("table population",
+                              { { "rows", qint64(diff.missing.size() + diff.extra.size() + diff.shared.size()) } });
+        comparison->setResults(&compareSession, std::move(diff));
+        for (int row : comparison->headingRows()) outputArea->setSpan(row, 0, 1, 2);
+    }
+
+    QTableView *resultTable() const { return outputArea; }
+
+    // See replaySessionEvent().
+    void replay(const SessionEvent &event) {
+        PermissionInputPane *pane = event.mirror ? mirrorInput : userInput;
+        switch (event.type) {
+        case SessionEvent::Type::Paste: pane->replayPaste(event.position, event.removed, event.text); break;
+        case SessionEvent::Type::Edit: pane->replayEdit(event.position, event.removed, event.text); break;
+        case SessionEvent::Type::Clear: pane->replayClear(); break;
+        case SessionEvent::Type::EditAsText: pane->replayEditAsText(); break;
+        case SessionEvent::Type::Compare: comparePermissions(); break;
+        }
     }
 
 private slots:
     void comparePermissions() {
-        QSet<QString> userPerms = parsePermissions(userInput->toPlainText());
-        QSet<QString> mirrorPerms = parsePermissions(mirrorInput->toPlainText());
-        // Difference: mirror - user
-        QStringList missing;
-        for (const QString &m : mirrorPerms) {
-            if (!userPerms.contains(m)) missing << m;
-        }
-        // Case-insensitive sort
-        std::sort(missing.begin(), missing.end(), [](const QString &a, const QString &b) {
-            return a.toCaseFolded() < b.toCaseFolded();
+        QElapsedTimer timer;
+        timer.start();
+        compareTexts(userInput->toPlainText(), mirrorInput->toPlainText());
+        if (SessionRecorder *recorder = sessionRecorder()) {
+            SessionEvent event;
+            event.type = SessionEvent::Type::Compare;
+            event.durationMs = timer.nsecsElapsed() / 1e6;
+            recorder->record(std::move(event));
+        }
+    }
+
+    // Exports take a copy of both inputs and the catalog snapshot; parsing, the diff
+    // and writing all happen on a worker thread, so the GUI stays responsive.
+    void exportResults() {
+        if (exportWatcher && exportWatcher->isRunning()) return;
+
+        const QString tsvFilter = "Tab-separated values (*.tsv)";
+        const QString csvFilter = "CSV (*.csv)";
+        const QString jsonlFilter = "JSON Lines (*.jsonl)";
+        const QString dataLoaderFilter = "Data Loader PermissionSetAssignment insert (*.csv)";
+        QString filter = csvFilter;
+        const QString path = QFileDialog::getSaveFileName(this, "Export Missing Permissions", QString(),
+            QStringList{ tsvFilter, csvFilter, jsonlFilter, dataLoaderFilter }.join(";;"), &filter);
+        if (path.isEmpty()) return;
+
+        ExportFormat format = ExportFormat::Csv;
+        if (filter == tsvFilter) format = ExportFormat::Tsv;
+        else if (filter == jsonlFilter) format = ExportFormat::JsonLines;
+        else if (filter == dataLoaderFilter) format = ExportFormat::DataLoader;
+
+        QString assigneeId;
+        if (format == ExportFormat::DataLoader) {
+            bool ok = false;
+            assigneeId = QInputDialog::getText(this, "Export for Data Loader",
+                                               "Salesforce User Id of the primary user (AssigneeId):",
+                                               QLineEdit::Normal, QString(), &ok).trimmed();
+            if (!ok || assigneeId.isEmpty()) return;
+        }
+
+        if (!exportWatcher) {
+            exportWatcher = new QFutureWatcher<ExportSummary>(this);
+            connect(exportWatcher, &QFutureWatcher<ExportSummary>::finished, this, &PermissionSetCalculator::finishExport);
+        }
+        exportButton->setEnabled(false);
+        statusBar()->showMessage("Exporting...");
+        exportWatcher->setFuture(JobScheduler::instance().run(JobPriority::Normal,
+            [path, format, assigneeId, userText = userInput->toPlainText(),
+             mirrorText = mirrorInput->toPlainText(), catalog = currentCatalog()] {
+                return exportComparison(path, format, assigneeId, userText, mirrorText, catalog);
+            }));
+    }
+
+    void finishExport() {
+        exportButton->setEnabled(true);
+        const ExportSummary summary = exportWatcher->result();
+        if (!summary.error.isEmpty()) {
+            statusBar()->clearMessage();
+            QMessageBox::warning(this, "Export Failed", summary.error);
+            return;
+        }
+        QString message = QString("Exported %1 rows").arg(summary.rows);
+        if (summary.unresolved > 0) {
+            message += QString("; %1 permission sets skipped because the catalog has no Id for them").arg(summary.unresolved);
+        }
+        statusBar()->showMessage(message, 8000);
+    }
+
+    void loadRoleTemplates() {
+        roleTemplateFile = roleTemplatePath();
+        QString error;
+        if (QFileInfo::exists(roleTemplateFile) && !roleTemplates.load(roleTemplateFile, &error)) {
+            statusBar()->showMessage(QString("Role templates not loaded: %1").arg(error), 8000);
+        }
+    }
+
+    void refreshTemplateMenus() {
+        useTemplateMenu->clear();
+        deleteTemplateMenu->clear();
+        for (const QString &name : roleTemplates.names()) {
+            useTemplateMenu->addAction(name, this, [this, name] { useTemplate(name); });
+            deleteTemplateMenu->addAction(name, this, [this, name] { deleteTemplate(name); });
+        }
+        useTemplateMenu->setEnabled(!roleTemplates.isEmpty());
+        deleteTemplateMenu->setEnabled(!roleTemplates.isEmpty());
+        bestFitAction->setEnabled(!roleTemplates.isEmpty());
+    }
+
+    bool saveRoleTemplates() {
+        QString error;
+        QDir().mkpath(QFileInfo(roleTemplateFile).absolutePath());
+        if (roleTemplates.save(roleTemplateFile, &error)) return true;
+        QMessageBox::warning(this, "Templates Not Saved", QString("Cannot write %1: %2").arg(roleTemplateFile, error));
+        return false;
+    }
+
+    void saveMirrorAsTemplate() {
+        const QStringList permissions = extractPermissionNames(mirrorInput->toPlainText());
+        if (permissions.isEmpty()) {
+            QMessageBox::information(this, "Save as Template", "Paste the permission sets of the role into the Mirror User box first.");
+            return;
+        }
+        const QString name = QInputDialog::getText(this, "Save as Template",
+                                                   QString("Name for this role (%1 permission sets):").arg(permissions.size())).trimmed();
+        if (name.isEmpty()) return;
+        if (roleTemplates.indexOf(name) >= 0
+            && QMessageBox::question(this, "Save as Template", QString("Replace the template \"%1\"?").arg(name)) != QMessageBox::Yes) {
+            return;
+        }
+        roleTemplates.setTemplate(name, permissions);
+        if (!saveRoleTemplates()) return;
+        refreshTemplateMenus();
+        statusBar()->showMessage(QString("Saved template \"%1\"").arg(name), 5000);
+    }
+
+    void useTemplate(const QString &name) {
+        const int index = roleTemplates.indexOf(name);
+        if (index < 0) return;
+        mirrorInput->setText(roleTemplates.permissions(index).join(u'\n'));
+        comparePermissions();
+        statusBar()->showMessage(QString("Compared against template \"%1\"").arg(name), 5000);
+    }
+
+    void deleteTemplate(const QString &name) {
+        if (QMessageBox::question(this, "Delete Template", QString("Delete the template \"%1\"?").arg(name)) != QMessageBox::Yes) return;
+        roleTemplates.removeTemplate(name);
+        saveRoleTemplates();
+        refreshTemplateMenus();
+    }
+
+    // Ranks every template against the primary user in one pass over the library.
+    void findBestTemplate() {
+        const QStringList user = extractPermissionNames(userInput->toPlainText());
+        if (user.isEmpty()) {
+            QMessageBox::information(this, "Best-Fitting Template", "Paste the primary user's permission sets first.");
+            return;
+        }
+        const std::vector<TemplateMatch> matches = roleTemplates.matchAll(user);
+        QStringList lines;
+        for (size_t i = 0; i < std::min<size_t>(matches.size(), 10); ++i) {
+            const TemplateMatch &m = matches[i];
+            lines << QString("%1. %2: %3% fit, %4 missing, %5 extra")
+                         .arg(i + 1)
+                         .arg(roleTemplates.names()[m.templateIndex])
+                         .arg(qRound(m.fit * 100))
+                         .arg(m.missing)
+                         .arg(m.extra);
+        }
+        QMessageBox box(QMessageBox::Information, "Best-Fitting Template", lines.join(u'\n'), QMessageBox::Close, this);
+        QPushButton *useBest = box.addButton("Compare with Best Fit", QMessageBox::AcceptRole);
+        box.exec();
+        if (box.clickedButton() == useBest) useTemplate(roleTemplates.names()[matches.front().templateIndex]);
+    }
+
+    void importAssignmentFile() {
+        if (assignmentWatcher->isRunning()) return;
+        const QString path = QFileDialog::getOpenFileName(this, "Import PermissionSetAssignment Export", QString(),
+                                                          "CSV (*.csv);;All files (*)");
+        if (path.isEmpty()) return;
+        statusBar()->showMessage("Importing assignments...");
+        assignmentWatcher->setFuture(JobScheduler::instance().run(JobPriority::Normal, [path] { return importAssignments(path); }));
+    }
+
+    void finishAssignmentImport() {
+        const AssignmentImport result = assignmentWatcher->result();
+        if (!result.error.isEmpty()) {
+            statusBar()->clearMessage();
+            QMessageBox::warning(this, "Import Failed", result.error);
+            return;
+        }
+        assignments = result.index;
+        batchPlanAction->setEnabled(true);
+        statusBar()->showMessage(QString("Imported %1 assignments for %2 users")
+                                     .arg(assignments->rows).arg(assignments->assignments.size()), 8000);
+    }
+
+    void generateProvisioningPlan() {
+        if (!assignments || batchPlanWatcher->isRunning()) return;
+        const QString manifest = QFileDialog::getOpenFileName(this, "Open Onboarding Manifest", QString(),
+                                                              "CSV (*.csv);;All files (*)");
+        if (manifest.isEmpty()) return;
+        const QString output = QFileDialog::getSaveFileName(this, "Save Provisioning Plan", "PermissionSetAssignment.csv",
+                                                            "Data Loader insert (*.csv)");
+        if (output.isEmpty()) return;
+        batchPlanAction->setEnabled(false);
+        statusBar()->showMessage("Generating provisioning plan...");
+        batchPlanWatcher->setFuture(JobScheduler::instance().run(JobPriority::Normal, [manifest, output, index = assignments] {
+            return generateBatchPlan(manifest, output, index);
+        }));
+    }
+
+    void finishProvisioningPlan() {
+        batchPlanAction->setEnabled(true);
+        const BatchPlanSummary summary = batchPlanWatcher->result();
+        if (!summary.error.isEmpty()) {
+            statusBar()->clearMessage();
+            QMessageBox::warning(this, "Provisioning Plan Failed", summary.error);
+            return;
+        }
+        statusBar()->showMessage(QString("%1 pairs: %2 assignments in %3 files")
+                                     .arg(summary.pairs).arg(summary.rows).arg(summary.files), 8000);
+        if (!summary.unresolved.isEmpty()) {
+            QStringList shown = summary.unresolved.mid(0, 20);
+            if (summary.unresolved.size() > shown.size()) shown << QString("... and %1 more").arg(summary.unresolved.size() - shown.size());
+            QMessageBox::information(this, "Unresolved Users",
+                QString("%1 pairs were skipped because these users are not in the imported assignments:\n\n%2")
+                    .arg(summary.unresolved.size()).arg(shown.join('\n')));
+        }
+    }
+
+    void switchOrg(const QString &org) {
+        if (org.isEmpty() || org == activeOrg) return;
+        activeOrg = org;
+        retargetCatalogWatcher();
+        // Load now rather than on the next compare so the switch is where any wait happens.
+        updateLineStatusCatalog();
+        statusBar()->showMessage(QString("Using %1 catalog").arg(org), 3000);
+    }
+
+    void startCatalogReload() {
+        const QString path = catalogs.pathFor(activeOrg);
+        if (QFileInfo::exists(path) && !catalogWatcher->files().contains(path)) {
+            catalogWatcher->addPath(path);
+        }
+        // Directory notifications also fire for unrelated files, including our own snapshot.
+        const QDateTime modified = QFileInfo(path).lastModified();
+        if (modified == watchedModified) return;
+
+        if (catalogReloadWatcher->isRunning()) {
+            catalogReloadPending = true;
+            return;
+        }
+        watchedModified = modified;
+        // A catalog that has not been loaded yet will be read fresh on first use.
+        const CatalogSnapshot live = catalogs.peek(activeOrg);
+        if (!live) return;
+        reloadingOrg = activeOrg;
+        catalogReloadWatcher->setFuture(JobScheduler::instance().run(JobPriority::Interactive, [path, live] {
+            return reloadCatalog(path, live);
+        }));
+    }
+
+    void finishCatalogReload() {
+        const CatalogReload result = catalogReloadWatcher->result();
+        if (!result.error.isEmpty()) {
+            // Retry once the writer is done; the next attempt must not be skipped as
+            // already seen.
+            watchedModified = QDateTime();
+            if (QFileInfo::exists(catalogs.pathFor(reloadingOrg))) catalogReloadTimer->start();
+            statusBar()->showMessage(QString("%1 catalog not reloaded: %2").arg(reloadingOrg, result.error), 5000);
+        } else if (!result.changedKeys.isEmpty()) {
+            catalogs.update(reloadingOrg, result.snapshot);
+            if (reloadingOrg == resultsOrg) refreshResultDescriptions();
+            if (reloadingOrg == activeOrg) updateLineStatusCatalog();
+            statusBar()->showMessage(QString("%1 catalog reloaded: %2 added, %3 removed, %4 changed")
+                                         .arg(reloadingOrg).arg(result.added).arg(result.removed).arg(result.changed), 5000);
+        }
+        if (catalogReloadPending) {
+            catalogReloadPending = false;
+            startCatalogReload();
+        }
+    }
+
+    // The mirror set is fixed when watching starts: the dropped mirror files if any,
+    // otherwise the Mirror User box.
+    void startWatchFolder() {
+        const QString inputDir = QFileDialog::getExistingDirectory(this, "Folder to Watch for User Exports");
+        if (inputDir.isEmpty()) return;
+        const QString outputDir = QFileDialog::getExistingDirectory(this, "Folder for Comparison Results", inputDir);
+        if (outputDir.isEmpty()) return;
+
+        const QSet<QString> mirrorPerms = droppedMirrorPerms.isEmpty()
+            ? parsePermissions(mirrorInput->toPlainText()) : droppedMirrorPerms;
+        if (mirrorPerms.isEmpty()) {
+            QMessageBox::information(this, "Watch Folder", "Enter or drop the mirror user's permission sets first.");
+            return;
+        }
+
+        stopWatchFolder();
+        watchPipeline = new WatchFolderPipeline(inputDir, outputDir, mirrorPerms, currentCatalog(), this);
+        connect(watchPipeline, &WatchFolderPipeline::metricsChanged, this, &PermissionSetCalculator::showWatchMetrics);
+        connect(watchPipeline, &WatchFolderPipeline::fileFailed, this, [this](const QString &path, const QString &error) {
+            statusBar()->showMessage(QString("%1: %2").arg(QFileInfo(path).fileName(), error), 8000);
         });
+        watchStartAction->setEnabled(false);
+        watchStopAction->setEnabled(true);
+        watchStatus->show();
+        showWatchMetrics();
+    }
 
-        outputArea->setRowCount(0);
-        if (!missing.isEmpty()) {
-            outputArea->setRowCount(missing.size());
-            for (int i = 0; i < missing.size(); ++i) {
-                QString perm = missing[i];
-                QString lower = perm.toLower();
-                QString desc = permDescriptions.value(lower, "");
-
-                QTableWidgetItem *nameItem = new QTableWidgetItem(perm);
-                // Make the name bold and dark red to highlight it
-                QFont boldFont;
-                boldFont.setBold(true);
-                nameItem->setFont(boldFont);
-                nameItem->setForeground(QBrush(QColor("#c53030")));
-
-                QTableWidgetItem *descItem = new QTableWidgetItem(desc);
-                descItem->setForeground(QBrush(QColor("#4b4f56"))); // Dark gray for description
-
-                outputArea->setItem(i, 0, nameItem);
-                outputArea->setItem(i, 1, descItem);
-            }
-            outputArea->resizeRowsToContents();
+    // The pipeline keeps no futures, so nothing is cancelled. Its jobs that are still
+    // queued in the JobScheduler run at Background priority once no Interactive or
+    // Normal work is waiting, and running ones finish, each still writing its output
+    // file. Their continuations are bound to the pipeline, so no result reaches it.
+    void stopWatchFolder() {
+        if (!watchPipeline) return;
+        watchPipeline->deleteLater();
+        watchPipeline = nullptr;
+        watchStartAction->setEnabled(true);
+        watchStopAction->setEnabled(false);
+        watchStatus->hide();
+    }
+
+    void showWatchMetrics() {
+        if (!watchPipeline) return;
+        const WatchFolderPipeline::Metrics m = watchPipeline->metrics();
+        watchStatus->setText(QString("Watching: %1 done, %2 failed | %3 settling, %4 queued, %5 running | %6 files/s")
+                                 .arg(m.processed).arg(m.failed).arg(m.waiting).arg(m.queued).arg(m.running)
+                                 .arg(m.filesPerSecond, 0, 'f', 1));
+    }
+
+    void collectDroppedFile(int index) {
+        const ParsedFile parsed = dropWatcher->resultAt(index);
+        if (dropIsMirror) {
+            for (const QString &name : parsed.names) droppedMirrorPerms.insert(name);
         } else {
-            outputArea->setRowCount(1);
-            QTableWidgetItem *msgItem = new QTableWidgetItem("No missing permissions.");
-            outputArea->setItem(0, 0, msgItem);
-            outputArea->setItem(0, 1, new QTableWidgetItem("The user already has all permission sets listed for the mirror user."));
+            batchResults->appendFile(parsed.path, parsed.missing);
         }
     }
-};
 
-int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
+    void finishDroppedFiles() {
+        dropProgress->hide();
+        dropCancelButton->hide();
+        const QString outcome = dropWatcher->isCanceled() ? "cancelled" : "done";
+        if (dropIsMirror) {
+            statusBar()->showMessage(QString("Mirror files %1: %2 permission sets. Drop primary user files to compare.")
+                                         .arg(outcome).arg(droppedMirrorPerms.size()), 8000);
+        } else {
+            statusBar()->showMessage(QString("Batch comparison %1: %2 missing assignments")
+                                         .arg(outcome).arg(batchResults->rowCount()), 8000);
+        }
+    }
+
+protected:
+    void paintEvent(QPaintEvent *event) override {
+        QMainWindow::paintEvent(event);
+        // The children paint after the window in the same backing store sync, so the
+        // frame is complete once control returns to the event loop.
+        if (!painted) {
+            painted = true;
+            QTimer::singleShot(0, this, [] { markStartup("first_paint"); });
+        }
+    }
+
+    void dragEnterEvent(QDragEnterEvent *event) override {
+        if (event->mimeData()->hasUrls()) event->acceptProposedAction();
+    }
+
+    void dragMoveEvent(QDragMoveEvent *event) override {
+        if (event->mimeData()->hasUrls()) event->acceptProposedAction();
+    }
+
+    // Files dropped on the Mirror User box form the mirror set; files dropped anywhere
+    // else are primary users, each compared against that set (or the mirror box's
+    // text when no mirror files were dropped). Parsing runs on the thread pool.
+    void dropEvent(QDropEvent *event) override {
+        QStringList paths;
+        for (const QUrl &url : event->mimeData()->urls()) {
+            if (url.isLocalFile() && QFileInfo(url.toLocalFile()).isFile()) paths << url.toLocalFile();
+        }
+        if (paths.isEmpty()) return;
+        event->acceptProposedAction();
+        if (dropWatcher->isRunning()) {
+            statusBar()->showMessage("Still processing the previous drop.", 3000);
+            return;
+        }
+
+        const QPoint pos = mirrorGroup->mapFrom(this, event->position().toPoint());
+        dropIsMirror = mirrorGroup->rect().contains(pos);
+        dropProgress->setValue(0);
+        dropProgress->show();
+        dropCancelButton->show();
+
+        if (dropIsMirror) {
+            droppedMirrorPerms.clear();
+            dropWatcher->setFuture(JobScheduler::instance().mapped(JobPriority::Normal, paths, [](const QString &path) {
+                return readPermissionFile(path);
+            }));
+            return;
+        }
 
-    // Global app icon preference (ICO then PNG)
-    const QStringList icons{ "Salesforce_perm_Calc_icon.ico", "Salesforce_perm_Calc_icon.png" };
-    for (const QString &ic : icons) {
-        QString p = resourcePath(ic);
-        if (QFileInfo::exists(p)) { app.setWindowIcon(QIcon(p)); break; }
+        const QSet<QString> mirrorPerms = droppedMirrorPerms.isEmpty()
+            ? parsePermissions(mirrorInput->toPlainText()) : droppedMirrorPerms;
+        showBatchResults();
+        batchResults->reset(currentCatalog());
+        dropWatcher->setFuture(JobScheduler::instance().mapped(JobPriority::Normal, paths, [mirrorPerms](const QString &path) {
+            ParsedFile parsed = readPermissionFile(path);
+            parsed.missing = missingPermissions(QSet<QString>(parsed.names.cbegin(), parsed.names.cend()), mirrorPerms);
+            return parsed;
+        }));
     }
 
-#ifdef _WIN32
-    // Set AppUserModelID for proper taskbar grouping/icon usage
-    const wchar_t *appId = L"com.vivint.salesforce.permcalc";
-    // Errors are non-critical; ignore return value
-    SetCurrentProcessExplicitAppUserModelID(appId);
-#endif
+private:
+    void showBatchResults() {
+        if (!batchResultsView) {
+            batchResults = new BatchResultModel(this);
+            batchResultsView = new QTableView(this);
+            batchResultsView->setWindowFlag(Qt::Window);
+            batchResultsView->setWindowTitle("Batch Comparison");
+            batchResultsView->setModel(batchResults);
+            batchResultsView->verticalHeader()->setVisible(false);
+            // Fixed row heights keep scrolling independent of the row count.
+            batchResultsView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+            batchResultsView->verticalHeader()->setDefaultSectionSize(ResultRowDelegate::RowHeight);
+            batchResultsView->setItemDelegate(new ResultRowDelegate(batchResultsView));
+            batchResultsView->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+            batchResultsView->horizontalHeader()->setStretchLastSection(true);
+            batchResultsView->setColumnWidth(0, 200);
+            batchResultsView->setColumnWidth(1, 280);
+            batchResultsView->setAlternatingRowColors(true);
+            batchResultsView->setShowGrid(false);
+            batchResultsView->setSelectionBehavior(QAbstractItemView::SelectRows);
+            batchResultsView->resize(900, 600);
+        }
+        batchResultsView->show();
+        batchResultsView->raise();
+    }
+
+    void updateLineStatusCatalog() {
+        const CatalogSnapshot snapshot = currentCatalog();
+        markStartup("catalog_loaded");
+        userInput->setCatalog(snapshot);
+        mirrorInput->setCatalog(snapshot);
+    }
+
+    // Re-resolves the description column against the reloaded catalog; the diff
+    // itself does not depend on the catalog and is not recomputed.
+    void refreshResultDescriptions() {
+        comparison->setCatalog(catalogs.acquire(resultsOrg));
+        descriptionDetail->hide();
+    }
+
+    // The word-wrapped description of a clicked result row, which the row itself
+    // shows on one elided line.
+    void showDescription(const QModelIndex &index) {
+        const QString description = comparison->index(index.row(), 1).data(Qt::ToolTipRole).toString();
+        if (description.isEmpty()) {
+            descriptionDetail->hide();
+            return;
+        }
+        const QString name = comparison->index(index.row(), 0).data().toString();
+        descriptionDetail->setText(QString("<b>%1</b>: %2").arg(name.toHtmlEscaped(), description.toHtmlEscaped()));
+        descriptionDetail->show();
+    }
+};
+
+QMainWindow *createPermissionSetCalculator() {
+    return new PermissionSetCalculator;
+}
+
+void comparePermissionTexts(QMainWindow *window, const QString &userText, const QString &mirrorText) {
+    static_cast<PermissionSetCalculator *>(window)->compareTexts(userText, mirrorText);
+}
 
-    PermissionSetCalculator window;
-    window.show();
+QTableView *comparisonTable(QMainWindow *window) {
+    return static_cast<PermissionSetCalculator *>(window)->resultTable();
+}
 
-    return app.exec();
+void replaySessionEvent(QMainWindow *window, const SessionEvent &event) {
+    static_cast<PermissionSetCalculator *>(window)->replay(event);
 }
 
 #include "perm_set_calculator.moc"
@@ -0,0 +1,107 @@
+/*
+ * libpermcalc: plain C interface to the Permission Set Comparator's parser and
+ * comparison engine, for tools that cannot link C++ or Qt directly.
+ *
+ * Conventions:
+ * - Text is UTF-8 passed as (pointer, length); it need not be NUL-terminated.
+ *   Input buffers stay owned by the caller. The parser works on UTF-16, so each
+ *   call decodes the text into a temporary copy; nothing refers to the caller's
+ *   buffer once the call returns.
+ * - Results are written into a caller-provided pc_arena. Returned pc_str and
+ *   array pointers point into that arena and stay valid until the caller reuses
+ *   or frees its memory. When the arena is too small, PC_ERR_ARENA_FULL is
+ *   returned, nothing is consumed, and arena->required holds the total size
+ *   needed, so the caller can grow the buffer and retry. The size allows for
+ *   alignment padding at any buffer address.
+ * - A pc_catalog is immutable once loaded and may be shared between threads.
+ *   A pc_session must be used by one thread at a time.
+ */
+
+#ifndef PERMCALC_H
+#define PERMCALC_H
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#  if defined(PERMCALC_BUILDING)
+#    define PERMCALC_API __declspec(dllexport)
+#  else
+#    define PERMCALC_API __declspec(dllimport)
+#  endif
+#else
+#  define PERMCALC_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERMCALC_API_VERSION 1
+
+typedef enum pc_status {
+    PC_OK = 0,
+    PC_ERR_INVALID_ARGUMENT = 1,
+    PC_ERR_IO = 2,
+    PC_ERR_ARENA_FULL = 3,
+    PC_ERR_INTERNAL = 4
+} pc_status;
+
+typedef struct pc_catalog pc_catalog;
+typedef struct pc_session pc_session;
+
+typedef struct pc_str {
+    const char *data;
+    size_t len;
+} pc_str;
+
+typedef struct pc_arena {
+    char *base;
+    size_t capacity;
+    size_t used;
+    size_t required; /* set on PC_ERR_ARENA_FULL */
+} pc_arena;
+
+/* A permission set in a result. id and description are empty when the session
+ * has no catalog or the catalog does not list the permission set. */
+typedef struct pc_permission {
+    pc_str name;
+    pc_str id;
+    pc_str description;
+} pc_permission;
+
+typedef struct pc_permission_list {
+    const pc_permission *items;
+    size_t count;
+} pc_permission_list;
+
+PERMCALC_API int pc_api_version(void);
+
+/* Catalogs: "Permission Sets.csv" files (Id, API name, name, description).
+ * pc_catalog_load returns PC_ERR_IO when the file cannot be read. It only reads
+ * the file and writes nothing next to it. */
+PERMCALC_API pc_status pc_catalog_load(const char *path, size_t path_len, pc_catalog **out);
+PERMCALC_API pc_status pc_catalog_parse(const char *csv, size_t csv_len, pc_catalog **out);
+PERMCALC_API size_t pc_catalog_size(const pc_catalog *catalog);
+PERMCALC_API void pc_catalog_free(pc_catalog *catalog);
+
+/* Stateless parsing: the permission set names in pasted or exported text, in
+ * first-seen order without duplicates. */
+PERMCALC_API pc_status pc_parse_permissions(const char *text, size_t text_len,
+                                            const pc_catalog *catalog, pc_arena *arena,
+                                            pc_permission_list *out);
+
+/* Sessions hold the parsed primary and mirror users between calls. catalog may
+ * be NULL and must outlive the session. */
+PERMCALC_API pc_status pc_session_create(const pc_catalog *catalog, pc_session **out);
+PERMCALC_API pc_status pc_session_set_primary(pc_session *session, const char *text, size_t text_len);
+PERMCALC_API pc_status pc_session_set_mirror(pc_session *session, const char *text, size_t text_len);
+/* Permission sets the mirror user has and the primary user lacks, sorted
+ * case-insensitively. */
+PERMCALC_API pc_status pc_session_missing(pc_session *session, pc_arena *arena, pc_permission_list *out);
+PERMCALC_API void pc_session_free(pc_session *session);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PERMCALC_H */
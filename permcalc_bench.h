@@ -0,0 +1,115 @@
+// Result reporting shared by the benchmark programs: a summary table on stdout and
+// the {"benchmarks": [{"name", "unit", "samples"}]} JSON that CI archives and
+// permcalc_bench_compare reads back. Programs that link Qt Widgets also get the
+// table paint passes that the UI and paint benchmarks share.
+
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QFile>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTextStream>
+
+#ifdef QT_WIDGETS_LIB
+#include <QtWidgets/QScrollBar>
+#include <QtWidgets/QTableView>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtGui/QImage>
+
+#include <initializer_list>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+struct Benchmark {
+    QString name;
+    QString unit;
+    std::vector<double> samples;
+};
+
+inline double median(std::vector<double> samples) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+inline void printBenchmarks(const std::vector<Benchmark> &results) {
+    QTextStream out(stdout);
+    for (const Benchmark &b : results) {
+        out << qSetFieldWidth(40) << Qt::left << b.name << qSetFieldWidth(0)
+            << QString::number(median(b.samples), 'f', 1) << ' ' << b.unit << " (median)\n";
+    }
+}
+
+inline bool writeBenchmarkJson(const QString &path, const std::vector<Benchmark> &results, QString *error = nullptr) {
+    QJsonArray benchmarks;
+    for (const Benchmark &b : results) {
+        QJsonArray samples;
+        for (double s : b.samples) samples.append(s);
+        benchmarks.append(QJsonObject{ { "name", b.name }, { "unit", b.unit }, { "samples", samples } });
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    file.write(QJsonDocument(QJsonObject{ { "benchmarks", benchmarks } }).toJson());
+    return true;
+}
+
+// Reads a file written by writeBenchmarkJson().
+inline bool readBenchmarkJson(const QString &path, std::vector<Benchmark> &results, QString *error = nullptr) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!document.isObject() || !document.object().value("benchmarks").isArray()) {
+        if (error) *error = parseError.error != QJsonParseError::NoError ? parseError.errorString() : "no benchmarks array";
+        return false;
+    }
+    results.clear();
+    for (const QJsonValue &value : document.object().value("benchmarks").toArray()) {
+        const QJsonObject object = value.toObject();
+        Benchmark b{ object.value("name").toString(), object.value("unit").toString(), {} };
+        for (const QJsonValue &sample : object.value("samples").toArray()) b.samples.push_back(sample.toDouble());
+        if (!b.name.isEmpty()) results.push_back(std::move(b));
+    }
+    return true;
+}
+
+#ifdef QT_WIDGETS_LIB
+// Average microseconds per viewport paint while paging from top to bottom.
+inline double scrollPass(QTableView &view, QImage &frame) {
+    QScrollBar *bar = view.verticalScrollBar();
+    const int step = std::max(1, bar->pageStep());
+    int frames = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (int value = bar->minimum(); value <= bar->maximum(); value += step) {
+        bar->setValue(value);
+        view.viewport()->render(&frame);
+        ++frames;
+    }
+    return double(timer.nsecsElapsed()) / 1000.0 / std::max(1, frames);
+}
+
+// Average microseconds per width change of `resized`, which is the view itself or
+// a window around it, including the table paint that follows each change.
+inline double resizePass(QWidget &resized, QTableView &view, QImage &frame, std::initializer_list<int> widths) {
+    QElapsedTimer timer;
+    timer.start();
+    for (int width : widths) {
+        resized.resize(width, resized.height());
+        QCoreApplication::sendPostedEvents();
+        view.viewport()->render(&frame);
+    }
+    return double(timer.nsecsElapsed()) / 1000.0 / std::max<size_t>(1, widths.size());
+}
+#endif
@@ -0,0 +1,164 @@
+// Compares two benchmark result files (permcalc_bench.h) and decides, per benchmark,
+// whether the difference is real or noise. Each pair of sample sets goes through a
+// two-sided Mann–Whitney U test, which is exact for small runs without ties and
+// uses the normal approximation otherwise. A benchmark counts as faster or slower
+// only when the test is significant and the medians differ by at least the
+// threshold. Higher is better for rates (units ending in "/s", such as MB/s). Lower
+// is better for everything else: times, allocations, bytes of RSS.
+//
+//   permcalc_bench_compare [--alpha 0.05] [--threshold 3] BASELINE.json CURRENT.json
+//
+// Exits with 1 if any benchmark is slower, 2 if a file cannot be read, else 0.
+
+#include "permcalc_bench.h"
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+
+#include <cmath>
+
+namespace {
+
+// Two-sided p-value of the Mann–Whitney U test for samples `a` and `b`.
+double mannWhitneyP(const std::vector<double> &a, const std::vector<double> &b) {
+    const size_t n1 = a.size();
+    const size_t n2 = b.size();
+    if (n1 == 0 || n2 == 0) return 1;
+
+    struct Ranked {
+        double value;
+        bool first;
+    };
+    std::vector<Ranked> all;
+    for (double v : a) all.push_back({ v, true });
+    for (double v : b) all.push_back({ v, false });
+    std::sort(all.begin(), all.end(), [](const Ranked &l, const Ranked &r) { return l.value < r.value; });
+
+    // Tied values share the average of their ranks.
+    double rankSum = 0;
+    double tieTerm = 0; // sum of t^3 - t over groups of t ties
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while (j < all.size() && all[j].value == all[i].value) ++j;
+        const double rank = (double(i + 1) + double(j)) / 2;
+        for (size_t k = i; k < j; ++k) {
+            if (all[k].first) rankSum += rank;
+        }
+        const double t = double(j - i);
+        tieTerm += t * t * t - t;
+        i = j;
+    }
+    const double u = rankSum - double(n1 * (n1 + 1)) / 2;
+
+    if (tieTerm == 0 && n1 <= 20 && n2 <= 20) {
+        // Exact: count the orderings of the two samples by their U statistic.
+        // counts[m][k] holds the orderings of m values of `a` and the current
+        // number of values of `b` that give U = k.
+        const size_t maxU = n1 * n2;
+        std::vector<std::vector<double>> counts(n1 + 1, std::vector<double>(maxU + 1, 0));
+        for (size_t m = 0; m <= n1; ++m) counts[m][0] = 1; // no values of `b` yet
+        for (size_t n = 1; n <= n2; ++n) {
+            std::vector<std::vector<double>> next(n1 + 1, std::vector<double>(maxU + 1, 0));
+            next[0][0] = 1;
+            for (size_t m = 1; m <= n1; ++m) {
+                for (size_t k = 0; k <= m * n; ++k) {
+                    // The largest value is from `a` (beating all n of `b`) or from `b`.
+                    next[m][k] = (k >= n ? next[m - 1][k - n] : 0) + counts[m][k];
+                }
+            }
+            counts = std::move(next);
+        }
+        const std::vector<double> &dist = counts[n1];
+        double total = 0;
+        double below = 0;
+        double above = 0;
+        for (size_t k = 0; k <= maxU; ++k) {
+            total += dist[k];
+            if (double(k) <= u) below += dist[k];
+            if (double(k) >= u) above += dist[k];
+        }
+        return std::min(1.0, 2 * std::min(below, above) / total);
+    }
+
+    const double n = double(n1 + n2);
+    const double variance = double(n1 * n2) / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance <= 0) return 1; // every sample identical
+    const double z = std::max(0.0, std::abs(u - double(n1 * n2) / 2) - 0.5) / std::sqrt(variance);
+    return std::erfc(z / std::sqrt(2.0));
+}
+
+bool higherIsBetter(const QString &unit) {
+    return unit.endsWith("/s");
+}
+
+const Benchmark *find(const std::vector<Benchmark> &results, const QString &name) {
+    for (const Benchmark &b : results) {
+        if (b.name == name) return &b;
+    }
+    return nullptr;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Reports benchmarks that got significantly faster or slower between two runs.");
+    parser.addHelpOption();
+    parser.addOption({ "alpha", "Significance level of the test.", "P", "0.05" });
+    parser.addOption({ "threshold", "Smallest median change, in percent, that counts.", "PERCENT", "3" });
+    parser.addPositionalArgument("baseline", "Benchmark JSON of the reference run.");
+    parser.addPositionalArgument("current", "Benchmark JSON of the run to check.");
+    parser.process(app);
+    if (parser.positionalArguments().size() != 2) parser.showHelp(2);
+    const double alpha = parser.value("alpha").toDouble();
+    const double threshold = parser.value("threshold").toDouble();
+
+    QTextStream out(stdout);
+    std::vector<Benchmark> baseline;
+    std::vector<Benchmark> current;
+    QString error;
+    for (int i = 0; i < 2; ++i) {
+        const QString path = parser.positionalArguments()[i];
+        if (!readBenchmarkJson(path, i == 0 ? baseline : current, &error)) {
+            out << "Cannot read " << path << ": " << error << '\n';
+            return 2;
+        }
+    }
+
+    int slower = 0;
+    int faster = 0;
+    for (const Benchmark &now : current) {
+        out << qSetFieldWidth(40) << Qt::left << now.name << qSetFieldWidth(0);
+        const Benchmark *before = find(baseline, now.name);
+        if (!before) {
+            out << "new, " << QString::number(median(now.samples), 'f', 1) << ' ' << now.unit << '\n';
+            continue;
+        }
+        if (before->unit != now.unit) {
+            out << "unit changed from " << before->unit << " to " << now.unit << ", not compared\n";
+            continue;
+        }
+        const double was = median(before->samples);
+        const double is = median(now.samples);
+        const double change = was != 0 ? (is - was) / std::abs(was) * 100 : 0;
+        const double p = mannWhitneyP(before->samples, now.samples);
+        const bool better = higherIsBetter(now.unit) ? change > 0 : change < 0;
+
+        QString verdict = "no significant change";
+        if (p < alpha && std::abs(change) >= threshold) {
+            verdict = better ? "FASTER" : "SLOWER";
+            ++(better ? faster : slower);
+        }
+        out << QString::number(was, 'f', 1) << " -> " << QString::number(is, 'f', 1) << ' ' << now.unit << "  "
+            << (change >= 0 ? "+" : "") << QString::number(change, 'f', 1) << "%  p=" << QString::number(p, 'g', 2)
+            << "  " << verdict << '\n';
+    }
+    for (const Benchmark &before : baseline) {
+        if (!find(current, before.name)) out << qSetFieldWidth(40) << Qt::left << before.name << qSetFieldWidth(0) << "missing\n";
+    }
+
+    out << faster << " faster, " << slower << " slower (alpha " << alpha << ", threshold " << threshold << "%)\n";
+    return slower > 0 ? 1 : 0;
+}
@@ -0,0 +1,173 @@
+// C interface of libpermcalc over the comparator core. See permcalc.h.
+
+#include "permcalc.h"
+#include "permcalc_core.h"
+
+#include <QtCore/QByteArray>
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct pc_catalog {
+    PermissionCatalog catalog;
+};
+
+struct pc_session {
+    const pc_catalog *catalog = nullptr;
+    QSet<QString> primary;
+    QSet<QString> mirror;
+};
+
+namespace {
+
+QString fromUtf8(const char *data, size_t len) {
+    return QString::fromUtf8(data, qsizetype(len));
+}
+
+// Lays out a pc_permission array followed by its UTF-8 strings in the arena. The
+// total size is computed first, so a short arena is reported before anything is
+// written and the caller can retry with arena->required bytes. That size allows for
+// the worst-case alignment padding, since the retry may use a buffer at another
+// address.
+pc_status writePermissions(const QStringList &names, const PermissionCatalog *catalog,
+                           pc_arena *arena, pc_permission_list *out) {
+    std::vector<QByteArray> strings;
+    strings.reserve(size_t(names.size()) * 3);
+    size_t stringBytes = 0;
+    for (const QString &name : names) {
+        const CatalogEntry *entry = catalog ? catalog->find(name) : nullptr;
+        strings.push_back(name.toUtf8());
+        strings.push_back(entry ? entry->id.toUtf8() : QByteArray());
+        strings.push_back(entry ? entry->description.toUtf8() : QByteArray());
+        for (size_t i = strings.size() - 3; i < strings.size(); ++i) stringBytes += size_t(strings[i].size());
+    }
+
+    const std::uintptr_t cursor = reinterpret_cast<std::uintptr_t>(arena->base) + arena->used;
+    const size_t padding = (alignof(pc_permission) - cursor % alignof(pc_permission)) % alignof(pc_permission);
+    const size_t itemBytes = size_t(names.size()) * sizeof(pc_permission);
+    const size_t needed = arena->used + padding + itemBytes + stringBytes;
+    if (needed > arena->capacity) {
+        arena->required = arena->used + alignof(pc_permission) - 1 + itemBytes + stringBytes;
+        return PC_ERR_ARENA_FULL;
+    }
+
+    pc_permission *items = reinterpret_cast<pc_permission *>(arena->base + arena->used + padding);
+    char *text = reinterpret_cast<char *>(items) + itemBytes;
+    auto place = [&text](const QByteArray &bytes) {
+        pc_str str{ text, size_t(bytes.size()) };
+        if (!bytes.isEmpty()) std::memcpy(text, bytes.constData(), size_t(bytes.size()));
+        text += bytes.size();
+        return str;
+    };
+    for (size_t i = 0; i < size_t(names.size()); ++i) {
+        pc_permission &item = items[i];
+        item.name = place(strings[i * 3]);
+        item.id = place(strings[i * 3 + 1]);
+        item.description = place(strings[i * 3 + 2]);
+    }
+
+    arena->used = needed;
+    arena->required = needed;
+    out->items = items;
+    out->count = size_t(names.size());
+    return PC_OK;
+}
+
+bool validArena(const pc_arena *arena) {
+    return arena && (arena->base || arena->capacity == 0) && arena->used <= arena->capacity;
+}
+
+// No C++ exception may cross the C boundary.
+template <typename Fn>
+pc_status guarded(Fn &&fn) {
+    try {
+        return fn();
+    } catch (...) {
+        return PC_ERR_INTERNAL;
+    }
+}
+
+} // namespace
+
+extern "C" {
+
+int pc_api_version(void) {
+    return PERMCALC_API_VERSION;
+}
+
+pc_status pc_catalog_load(const char *path, size_t path_len, pc_catalog **out) {
+    if (!path || !out) return PC_ERR_INVALID_ARGUMENT;
+    return guarded([&] {
+        // Read directly rather than through loadCatalog, which would write a
+        // snapshot file next to the caller's CSV.
+        QString text;
+        if (!readTextFile(fromUtf8(path, path_len), text)) return PC_ERR_IO;
+        *out = new pc_catalog{ parseCatalogText(text) };
+        return PC_OK;
+    });
+}
+
+pc_status pc_catalog_parse(const char *csv, size_t csv_len, pc_catalog **out) {
+    if ((!csv && csv_len) || !out) return PC_ERR_INVALID_ARGUMENT;
+    return guarded([&] {
+        *out = new pc_catalog{ parseCatalogText(fromUtf8(csv, csv_len)) };
+        return PC_OK;
+    });
+}
+
+size_t pc_catalog_size(const pc_catalog *catalog) {
+    return catalog ? size_t(catalog->catalog.entries.size()) : 0;
+}
+
+void pc_catalog_free(pc_catalog *catalog) {
+    delete catalog;
+}
+
+pc_status pc_parse_permissions(const char *text, size_t text_len, const pc_catalog *catalog,
+                               pc_arena *arena, pc_permission_list *out) {
+    if ((!text && text_len) || !validArena(arena) || !out) return PC_ERR_INVALID_ARGUMENT;
+    return guarded([&] {
+        const QStringList names = extractPermissionNames(fromUtf8(text, text_len));
+        return writePermissions(names, catalog ? &catalog->catalog : nullptr, arena, out);
+    });
+}
+
+pc_status pc_session_create(const pc_catalog *catalog, pc_session **out) {
+    if (!out) return PC_ERR_INVALID_ARGUMENT;
+    return guarded([&] {
+        *out = new pc_session;
+        (*out)->catalog = catalog;
+        return PC_OK;
+    });
+}
+
+pc_status pc_session_set_primary(pc_session *session, const char *text, size_t text_len) {
+    if (!session || (!text && text_len)) return PC_ERR_INVALID_ARGUMENT;
+    return guarded([&] {
+        session->primary = parsePermissions(fromUtf8(text, text_len));
+        return PC_OK;
+    });
+}
+
+pc_status pc_session_set_mirror(pc_session *session, const char *text, size_t text_len) {
+    if (!session || (!text && text_len)) return PC_ERR_INVALID_ARGUMENT;
+    return guarded([&] {
+        session->mirror = parsePermissions(fromUtf8(text, text_len));
+        return PC_OK;
+    });
+}
+
+pc_status pc_session_missing(pc_session *session, pc_arena *arena, pc_permission_list *out) {
+    if (!session || !validArena(arena) || !out) return PC_ERR_INVALID_ARGUMENT;
+    return guarded([&] {
+        const QStringList missing = missingPermissions(session->primary, session->mirror);
+        return writePermissions(missing, session->catalog ? &session->catalog->catalog : nullptr, arena, out);
+    });
+}
+
+void pc_session_free(pc_session *session) {
+    delete session;
+}
+
+} // extern "C"
@@ -0,0 +1,806 @@
+// Parsing, catalog and comparison core of the Permission Set Comparator.
+// See permcalc_core.h.
+
+#include "permcalc_core.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QFile>
+#include <QtCore/QStringDecoder>
+#include <QtCore/QSaveFile>
+#include <QtCore/QDateTime>
+#include <QtCore/QtAlgorithms>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <iterator>
+#include <unordered_set>
+
+// Hand-written equivalents of the former regular expressions, so that tokens can be
+// checked as views without building QStrings:
+//   date:        ^\d{1,2}/\d{1,2}/\d{2,4}$
+//   action date: ^(?:add|del|delete|remove)\s+<date>$   (case-insensitive)
+static bool isDate(QStringView s) {
+    qsizetype i = 0;
+    auto digits = [&s, &i](int min, int max) {
+        int count = 0;
+        while (i < s.size() && count < max && s[i].isDigit()) { ++i; ++count; }
+        return count >= min;
+    };
+    if (!digits(1, 2) || i >= s.size() || s[i] != u'/') return false;
+    ++i;
+    if (!digits(1, 2) || i >= s.size() || s[i] != u'/') return false;
+    ++i;
+    return digits(2, 4) && i == s.size();
+}
+
+bool isActionWord(QStringView s) {
+    return s.compare(QLatin1String("add"), Qt::CaseInsensitive) == 0
+        || s.compare(QLatin1String("del"), Qt::CaseInsensitive) == 0
+        || s.compare(QLatin1String("delete"), Qt::CaseInsensitive) == 0
+        || s.compare(QLatin1String("remove"), Qt::CaseInsensitive) == 0;
+}
+
+static bool isActionDate(QStringView line) {
+    qsizetype i = 0;
+    while (i < line.size() && !line[i].isSpace()) ++i;
+    if (!isActionWord(line.left(i))) return false;
+    qsizetype j = i;
+    while (j < line.size() && line[j].isSpace()) ++j;
+    return j > i && isDate(line.mid(j));
+}
+
+static void splitTrimmed(QStringView line, QChar separator, std::pmr::vector<QStringView> &tokens) {
+    qsizetype start = 0;
+    for (;;) {
+        const qsizetype end = line.indexOf(separator, start);
+        const QStringView part = line.mid(start, end < 0 ? -1 : end - start).trimmed();
+        if (!part.isEmpty()) tokens.push_back(part);
+        if (end < 0) break;
+        start = end + 1;
+    }
+}
+
+void tokenizeLine(QStringView rawLine, std::pmr::vector<QStringView> &tokens) {
+    tokens.clear();
+    if (rawLine.contains(u'\t')) {
+        splitTrimmed(rawLine, u'\t', tokens);
+        return;
+    }
+
+    // Split by 2+ spaces
+    const QStringView line = rawLine.trimmed();
+    qsizetype start = 0;
+    for (qsizetype i = 0; i < line.size();) {
+        if (!line[i].isSpace()) { ++i; continue; }
+        qsizetype j = i;
+        while (j < line.size() && line[j].isSpace()) ++j;
+        if (j - i >= 2) {
+            tokens.push_back(line.mid(start, i - start));
+            start = j;
+        }
+        i = j;
+    }
+    if (start < line.size()) tokens.push_back(line.mid(start));
+    if (tokens.size() > 1) return;
+
+    // Fallback: comma separated
+    if (rawLine.contains(u',')) {
+        tokens.clear();
+        splitTrimmed(rawLine, u',', tokens);
+        return;
+    }
+    tokens.assign(1, line);
+}
+
+QStringList tokenizeLine(const QString &rawLine) {
+    std::pmr::vector<QStringView> tokens;
+    tokenizeLine(QStringView(rawLine), tokens);
+    QStringList result;
+    result.reserve(qsizetype(tokens.size()));
+    for (QStringView t : tokens) result << t.toString();
+    return result;
+}
+
+static char16_t foldCase(QChar c) {
+    const char16_t u = c.unicode();
+    if (u < 128) return (u >= u'A' && u <= u'Z') ? char16_t(u + 32) : u;
+    return c.toCaseFolded().unicode();
+}
+
+NoisePhraseMatcher::NoisePhraseMatcher(const QStringList &extraHeaders, const QStringList &extraIgnored) {
+    ascii.assign(AsciiSize, -1);
+    wide.emplace_back();
+    fail.push_back(0);
+    outputs.emplace_back();
+
+    add(QStringLiteral("permission set name"), Header);
+    add(QStringLiteral("action"), Action);
+    add(QStringLiteral("expires on"), Ignored);
+    add(QStringLiteral("date assigned"), Ignored);
+    for (const QString &phrase : extraHeaders) add(phrase, Header);
+    for (const QString &phrase : extraIgnored) add(phrase, Ignored);
+    build();
+}
+
+void NoisePhraseMatcher::add(const QString &phrase, Kind kind) {
+    const QString trimmed = phrase.trimmed();
+    if (trimmed.isEmpty() || trimmed.size() > 0xffff) return;
+    int state = 0;
+    for (QChar ch : trimmed) {
+        const char16_t c = foldCase(ch);
+        int next = -1;
+        if (c < AsciiSize) {
+            next = ascii[size_t(state) * AsciiSize + c];
+        } else {
+            for (const auto &edge : wide[size_t(state)]) {
+                if (edge.first == c) next = edge.second;
+            }
+        }
+        if (next < 0) {
+            next = int(fail.size());
+            ascii.resize(ascii.size() + AsciiSize, -1);
+            wide.emplace_back();
+            fail.push_back(0);
+            outputs.emplace_back();
+            if (c < AsciiSize) ascii[size_t(state) * AsciiSize + c] = next;
+            else wide[size_t(state)].emplace_back(c, next);
+        }
+        state = next;
+    }
+    outputs[size_t(state)].push_back(Output{ quint16(trimmed.size()), kind });
+}
+
+int NoisePhraseMatcher::wideStep(int state, char16_t c) const {
+    for (;;) {
+        for (const auto &edge : wide[size_t(state)]) {
+            if (edge.first == c) return edge.second;
+        }
+        if (state == 0) return 0;
+        state = fail[size_t(state)];
+    }
+}
+
+// Breadth-first over the trie: sets failure links, inherits the outputs of each
+// state's failure state, and completes the ASCII table into a DFA so that ASCII
+// text never follows a failure link while scanning.
+void NoisePhraseMatcher::build() {
+    std::deque<int> queue;
+    auto visit = [this, &queue](int child, int failure) {
+        fail[size_t(child)] = failure;
+        const std::vector<Output> &inherited = outputs[size_t(failure)];
+        outputs[size_t(child)].insert(outputs[size_t(child)].end(), inherited.begin(), inherited.end());
+        queue.push_back(child);
+    };
+    for (int c = 0; c < AsciiSize; ++c) {
+        int &next = ascii[size_t(c)];
+        if (next < 0) next = 0;
+        else visit(next, 0);
+    }
+    for (const auto &edge : wide[0]) visit(edge.second, 0);
+
+    while (!queue.empty()) {
+        const int state = queue.front();
+        queue.pop_front();
+        const size_t row = size_t(state) * AsciiSize;
+        const size_t failRow = size_t(fail[size_t(state)]) * AsciiSize;
+        for (int c = 0; c < AsciiSize; ++c) {
+            int &next = ascii[row + size_t(c)];
+            if (next < 0) next = ascii[failRow + size_t(c)];
+            else visit(next, ascii[failRow + size_t(c)]);
+        }
+        for (const auto &edge : wide[size_t(state)]) visit(edge.second, wideStep(fail[size_t(state)], edge.first));
+    }
+}
+
+void NoisePhraseMatcher::scan(QStringView text, std::pmr::vector<Match> &matches) const {
+    int state = 0;
+    for (qsizetype i = 0; i < text.size(); ++i) {
+        const char16_t c = foldCase(text[i]);
+        state = c < AsciiSize ? ascii[size_t(state) * AsciiSize + c] : wideStep(state, c);
+        for (const Output &out : outputs[size_t(state)]) {
+            const QChar *end = text.data() + i + 1;
+            matches.push_back(Match{ end - out.length, end, out.kind });
+        }
+    }
+}
+
+// Replaced matchers are never freed: a parse on another thread may still be using
+// one, and a process only ever configures a handful.
+static std::atomic<const NoisePhraseMatcher *> configuredNoisePhrases{ nullptr };
+
+const NoisePhraseMatcher &noisePhrases() {
+    if (const NoisePhraseMatcher *configured = configuredNoisePhrases.load(std::memory_order_acquire)) {
+        return *configured;
+    }
+    static const NoisePhraseMatcher defaults;
+    return defaults;
+}
+
+void setExtraNoisePhrases(const QStringList &headerPhrases, const QStringList &ignoredPhrases) {
+    configuredNoisePhrases.store(new NoisePhraseMatcher(headerPhrases, ignoredPhrases), std::memory_order_release);
+}
+
+QStringView extractPermissionName(QStringView rawLine, std::pmr::vector<QStringView> &tokens,
+                                  std::pmr::vector<NoisePhraseMatcher::Match> &matches) {
+    const QStringView line = rawLine.trimmed();
+    if (line.isEmpty()) return QStringView();
+
+    // Every noise phrase of the line comes from this one scan; the checks below only
+    // look at where the matches fall. Most lines have none.
+    matches.clear();
+    noisePhrases().scan(line, matches);
+    auto contains = [&matches](QStringView within, NoisePhraseMatcher::Kind kind) {
+        for (const NoisePhraseMatcher::Match &m : matches) {
+            if (m.kind == kind && m.begin >= within.begin() && m.end <= within.end()) return true;
+        }
+        return false;
+    };
+
+    if (contains(line, NoisePhraseMatcher::Header) && contains(line, NoisePhraseMatcher::Action)) return QStringView();
+    if (isActionDate(line)) return QStringView();
+
+    tokenizeLine(rawLine, tokens);
+    if (tokens.empty()) return QStringView();
+
+    for (QStringView token : tokens) {
+        const QStringView trimmed = token.trimmed();
+        if (trimmed.isEmpty()) continue;
+        if (isActionWord(trimmed)) continue;
+        if (isDate(trimmed)) continue;
+        if (contains(trimmed, NoisePhraseMatcher::Ignored)) continue;
+        if (contains(trimmed, NoisePhraseMatcher::Header)) return QStringView();
+        return trimmed; // first valid token
+    }
+
+    const QStringView fallback = tokens.front().trimmed();
+    if (isActionWord(fallback)) return QStringView();
+    if (isDate(fallback)) return QStringView();
+    return fallback;
+}
+
+QString extractPermissionName(const QString &rawLine) {
+    std::pmr::vector<QStringView> tokens;
+    std::pmr::vector<NoisePhraseMatcher::Match> matches;
+    return extractPermissionName(QStringView(rawLine), tokens, matches).toString();
+}
+
+QStringList extractPermissionNames(const QString &raw) {
+    QStringList names;
+    QSet<QStringView> seen;
+    std::pmr::vector<QStringView> tokens;
+    std::pmr::vector<NoisePhraseMatcher::Match> matches;
+    const QStringView text(raw);
+    qsizetype start = 0;
+    for (;;) {
+        const qsizetype end = text.indexOf(u'\n', start);
+        const QStringView line = text.mid(start, end < 0 ? -1 : end - start);
+        const QStringView candidate = extractPermissionName(line, tokens, matches);
+        if (!candidate.isEmpty() && !seen.contains(candidate)) {
+            names << candidate.toString();
+            seen.insert(candidate);
+        }
+        if (end < 0) break;
+        start = end + 1;
+    }
+    return names;
+}
+
+QSet<QString> parsePermissions(const QString &raw) {
+    const QStringList names = extractPermissionNames(raw);
+    return QSet<QString>(names.cbegin(), names.cend());
+}
+
+bool nameLess(QStringView a, QStringView b) {
+    return a.compare(b, Qt::CaseInsensitive) < 0;
+}
+
+QStringList missingPermissions(const QSet<QString> &userPerms, const QSet<QString> &mirrorPerms) {
+    QStringList missing;
+    for (const QString &m : mirrorPerms) {
+        if (!userPerms.contains(m)) missing << m;
+    }
+    std::sort(missing.begin(), missing.end(), [](const QString &a, const QString &b) {
+        return nameLess(a, b);
+    });
+    return missing;
+}
+
+namespace {
+
+struct Sniffed {
+    TextEncoding encoding = TextEncoding::Utf8;
+    qsizetype bomLength = 0;
+    bool ascii = false;
+};
+
+// Length of the leading run of ASCII bytes, tested eight bytes at a time.
+qsizetype asciiPrefix(const uchar *p, qsizetype n) {
+    qsizetype i = 0;
+    for (; i + 8 <= n; i += 8) {
+        quint64 word;
+        std::memcpy(&word, p + i, sizeof(word));
+        if (word & 0x8080808080808080ULL) break;
+    }
+    while (i < n && p[i] < 0x80) ++i;
+    return i;
+}
+
+enum class Utf8Check { Ascii, Valid, Invalid };
+
+// Rejects overlong forms, surrogates, code points above U+10FFFF and truncated
+// sequences. ASCII runs, the bulk of any export, are skipped word by word.
+Utf8Check checkUtf8(const uchar *p, qsizetype n) {
+    bool ascii = true;
+    qsizetype i = 0;
+    for (;;) {
+        i += asciiPrefix(p + i, n - i);
+        if (i >= n) break;
+        ascii = false;
+        const uchar lead = p[i];
+        int length = 0;
+        if (lead >= 0xC2 && lead <= 0xDF) length = 2;
+        else if ((lead & 0xF0) == 0xE0) length = 3;
+        else if (lead >= 0xF0 && lead <= 0xF4) length = 4;
+        else return Utf8Check::Invalid;
+        if (n - i < length) return Utf8Check::Invalid;
+        char32_t cp = lead & (0xFF >> (length + 1));
+        for (int k = 1; k < length; ++k) {
+            if ((p[i + k] & 0xC0) != 0x80) return Utf8Check::Invalid;
+            cp = (cp << 6) | (p[i + k] & 0x3F);
+        }
+        if (length == 3 && (cp < 0x800 || (cp >= 0xD800 && cp <= 0xDFFF))) return Utf8Check::Invalid;
+        if (length == 4 && (cp < 0x10000 || cp > 0x10FFFF)) return Utf8Check::Invalid;
+        i += length;
+    }
+    return ascii ? Utf8Check::Ascii : Utf8Check::Valid;
+}
+
+Sniffed sniffEncoding(QByteArrayView bytes) {
+    const auto *p = reinterpret_cast<const uchar *>(bytes.data());
+    const qsizetype n = bytes.size();
+    if (n >= 3 && p[0] == 0xEF && p[1] == 0xBB && p[2] == 0xBF) {
+        Sniffed sniffed{ TextEncoding::Utf8, 3, false };
+        sniffed.ascii = checkUtf8(p + 3, n - 3) == Utf8Check::Ascii;
+        return sniffed;
+    }
+    if (n >= 2 && p[0] == 0xFF && p[1] == 0xFE) return { TextEncoding::Utf16LE, 2, false };
+    if (n >= 2 && p[0] == 0xFE && p[1] == 0xFF) return { TextEncoding::Utf16BE, 2, false };
+
+    // Mostly-ASCII UTF-16 has a NUL in every other byte; the 8-bit encodings have none.
+    const qsizetype sample = std::min<qsizetype>(n & ~qsizetype(1), 4096);
+    if (sample >= 4) {
+        qsizetype zeroEven = 0;
+        qsizetype zeroOdd = 0;
+        for (qsizetype i = 0; i < sample; i += 2) {
+            zeroEven += p[i] == 0;
+            zeroOdd += p[i + 1] == 0;
+        }
+        const qsizetype units = sample / 2;
+        if (zeroOdd * 10 >= units * 3 && zeroEven * 10 < units) return { TextEncoding::Utf16LE, 0, false };
+        if (zeroEven * 10 >= units * 3 && zeroOdd * 10 < units) return { TextEncoding::Utf16BE, 0, false };
+    }
+
+    switch (checkUtf8(p, n)) {
+    case Utf8Check::Ascii: return { TextEncoding::Utf8, 0, true };
+    case Utf8Check::Valid: return { TextEncoding::Utf8, 0, false };
+    case Utf8Check::Invalid: break;
+    }
+    return { TextEncoding::Windows1252, 0, false };
+}
+
+// 0x80-0x9F of Windows-1252; every other byte is the same code point as in Latin-1.
+// The five unassigned bytes map to the C1 controls, as Windows does.
+const char16_t windows1252High[32] = {
+    0x20AC, 0x0081, 0x201A, 0x0192, 0x201E, 0x2026, 0x2020, 0x2021,
+    0x02C6, 0x2030, 0x0160, 0x2039, 0x0152, 0x008D, 0x017D, 0x008F,
+    0x0090, 0x2018, 0x2019, 0x201C, 0x201D, 0x2022, 0x2013, 0x2014,
+    0x02DC, 0x2122, 0x0161, 0x203A, 0x0153, 0x009D, 0x017E, 0x0178,
+};
+
+QString decodeWindows1252(QByteArrayView bytes) {
+    QString text(bytes.size(), Qt::Uninitialized);
+    QChar *out = text.data();
+    for (char ch : bytes) {
+        const uchar c = uchar(ch);
+        *out++ = QChar(c >= 0x80 && c < 0xA0 ? windows1252High[c - 0x80] : char16_t(c));
+    }
+    return text;
+}
+
+} // namespace
+
+TextEncoding detectEncoding(QByteArrayView bytes) {
+    return sniffEncoding(bytes).encoding;
+}
+
+QString decodeText(QByteArrayView bytes, TextEncoding *encoding) {
+    const Sniffed sniffed = sniffEncoding(bytes);
+    if (encoding) *encoding = sniffed.encoding;
+    const QByteArrayView body = bytes.sliced(sniffed.bomLength);
+    switch (sniffed.encoding) {
+    case TextEncoding::Utf8:
+        // Pure ASCII is the common case and widens without any decoding.
+        return sniffed.ascii ? QString::fromLatin1(body) : QString::fromUtf8(body);
+    case TextEncoding::Utf16LE:
+    case TextEncoding::Utf16BE: {
+        QStringDecoder decoder(sniffed.encoding == TextEncoding::Utf16LE ? QStringConverter::Utf16LE
+                                                                         : QStringConverter::Utf16BE,
+                               QStringConverter::Flag::Stateless);
+        return decoder.decode(body);
+    }
+    case TextEncoding::Windows1252:
+        return decodeWindows1252(body);
+    }
+    return QString();
+}
+
+bool readTextFile(const QString &path, QString &text, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    text.clear();
+    const qint64 size = file.size();
+    if (size <= 0) return true;
+    if (uchar *data = file.map(0, size)) {
+        text = decodeText(QByteArrayView(data, qsizetype(size)));
+        file.unmap(data);
+    } else {
+        text = decodeText(file.readAll());
+    }
+    return true;
+}
+
+QStringList splitCsvLine(QStringView line) {
+    QStringList parts;
+    QString current;
+    bool inQuote = false;
+    for (int i = 0; i < line.length(); ++i) {
+        QChar c = line[i];
+        if (c == '"') {
+            inQuote = !inQuote;
+        } else if (c == ',' && !inQuote) {
+            parts << current;
+            current.clear();
+        } else {
+            current += c;
+        }
+    }
+    parts << current;
+    return parts;
+}
+
+void PermissionCatalog::indexNames() {
+    names.clear();
+    nameIds.clear();
+    names.reserve(entries.size());
+    for (const CatalogEntry &entry : entries) names << entry.name;
+    std::sort(names.begin(), names.end(), [](const QString &a, const QString &b) { return nameLess(a, b); });
+    nameIds.reserve(size_t(names.size()));
+    for (qsizetype i = 0; i < names.size(); ++i) nameIds.emplace(QStringView(names[i]), NameId(i));
+}
+
+static void addCatalogLine(PermissionCatalog &catalog, QStringView line) {
+    QStringList parts = splitCsvLine(line);
+    if (parts.size() < 4) return;
+
+    CatalogEntry entry;
+    entry.id = parts[0].trimmed();
+    entry.apiName = parts[1].trimmed();
+    entry.name = parts[2].trimmed();
+    QString desc = parts[3].trimmed();
+    if (desc.startsWith('"') && desc.endsWith('"')) {
+        desc = desc.mid(1, desc.length() - 2);
+        desc.replace("\"\"", "\"");
+    }
+    entry.description = desc;
+    if (!entry.name.isEmpty()) {
+        catalog.entries.insert(entry.name.toLower(), entry);
+    }
+}
+
+PermissionCatalog parseCatalogCsv(const QString &path) {
+    QString text;
+    if (!readTextFile(path, text)) return PermissionCatalog();
+    return parseCatalogText(text);
+}
+
+PermissionCatalog parseCatalogText(const QString &text) {
+    PermissionCatalog catalog;
+    bool header = true;
+    forEachLine(text, [&catalog, &header](QStringView line) {
+        // Skip header
+        if (header) header = false;
+        else addCatalogLine(catalog, line);
+    });
+    catalog.indexNames();
+    return catalog;
+}
+
+QDataStream &operator<<(QDataStream &out, const CatalogEntry &entry) {
+    return out << entry.id << entry.apiName << entry.name << entry.description;
+}
+
+QDataStream &operator>>(QDataStream &in, CatalogEntry &entry) {
+    return in >> entry.id >> entry.apiName >> entry.name >> entry.description;
+}
+
+// Snapshot header: magic, format version, then the size and modification time of
+// the CSV it was built from.
+static const quint32 SNAPSHOT_MAGIC = 0x50534331; // "PSC1"
+static const quint16 SNAPSHOT_VERSION = 1;
+
+QString snapshotPath(const QString &csvPath) {
+    return csvPath + ".snapshot";
+}
+
+bool loadCatalogSnapshot(const QString &csvPath, PermissionCatalog &catalog) {
+    const QFileInfo source(csvPath);
+    QFile file(snapshotPath(csvPath));
+    if (!source.exists() || !file.open(QIODevice::ReadOnly)) return false;
+
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    qint64 sourceSize = 0;
+    qint64 sourceModified = 0;
+    in >> magic >> version >> sourceSize >> sourceModified;
+    if (magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION) return false;
+    if (sourceSize != source.size() || sourceModified != source.lastModified().toMSecsSinceEpoch()) return false;
+
+    PermissionCatalog loaded;
+    in >> loaded.entries;
+    if (in.status() != QDataStream::Ok) return false;
+    loaded.indexNames();
+    catalog = std::move(loaded);
+    return true;
+}
+
+void saveCatalogSnapshot(const QString &csvPath, const PermissionCatalog &catalog) {
+    const QFileInfo source(csvPath);
+    if (!source.exists()) return;
+    QSaveFile file(snapshotPath(csvPath));
+    if (!file.open(QIODevice::WriteOnly)) return;
+
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << SNAPSHOT_MAGIC << SNAPSHOT_VERSION
+        << qint64(source.size()) << qint64(source.lastModified().toMSecsSinceEpoch())
+        << catalog.entries;
+    file.commit();
+}
+
+PermissionCatalog loadCatalog(const QString &csvPath) {
+    PermissionCatalog catalog;
+    if (loadCatalogSnapshot(csvPath, catalog)) return catalog;
+    catalog = parseCatalogCsv(csvPath);
+    if (!catalog.entries.isEmpty()) saveCatalogSnapshot(csvPath, catalog);
+    return catalog;
+}
+
+ParsedFile readPermissionFile(const QString &path) {
+    ParsedFile parsed;
+    parsed.path = path;
+    QString text;
+    if (!readTextFile(path, text, &parsed.error)) return parsed;
+    parsed.names = extractPermissionNames(text);
+    return parsed;
+}
+
+ParseSession::ParseSession(size_t initialBytes)
+    : arena(initialBytes) {
+    reset(nullptr);
+}
+
+void ParseSession::reset(const CatalogSnapshot &catalog) {
+    // Everything allocated from the arena must be dropped before it is released.
+    tokens.reset();
+    matches.reset();
+    localIds.reset();
+    localNames.reset();
+    marks.reset();
+    arena.release();
+    pinned.clear();
+
+    catalogSnapshot = catalog;
+    catalogSize = catalog ? NameId(catalog->names.size()) : 0;
+    tokens.emplace(&arena);
+    matches.emplace(&arena);
+    localNames.emplace(&arena);
+    localIds.emplace(0, NameViewHash(), std::equal_to<QStringView>(), &arena);
+    marks.emplace(&arena);
+}
+
+NameId ParseSession::intern(QStringView name) {
+    if (catalogSnapshot) {
+        const auto it = catalogSnapshot->nameIds.find(name);
+        if (it != catalogSnapshot->nameIds.end()) return it->second;
+    }
+    const auto [it, inserted] = localIds->emplace(name, catalogSize + NameId(localNames->size()));
+    if (inserted) localNames->push_back(name);
+    return it->second;
+}
+
+// One byte per interned id, cleared to zero; grown as parsing interns new names.
+std::pmr::vector<quint8> &ParseSession::clearedMarks() {
+    marks->assign(idCount(), 0);
+    return *marks;
+}
+
+ParseSession::IdList ParseSession::parse(const QString &text) {
+    pinned << text;
+    const QStringView view(pinned.constLast());
+    IdList ids(&arena);
+    std::pmr::vector<quint8> &seen = clearedMarks();
+    qsizetype start = 0;
+    for (;;) {
+        const qsizetype end = view.indexOf(u'\n', start);
+        const QStringView line = view.mid(start, end < 0 ? -1 : end - start);
+        const QStringView candidate = extractPermissionName(line, *tokens, *matches);
+        if (!candidate.isEmpty()) {
+            const NameId id = intern(candidate);
+            if (id >= seen.size()) seen.resize(size_t(id) + 1, 0);
+            if (!seen[id]) {
+                seen[id] = 1;
+                ids.push_back(id);
+            }
+        }
+        if (end < 0) break;
+        start = end + 1;
+    }
+    return ids;
+}
+
+// Thresholds from timing the four strategies of ParseSession::diff on random ids,
+// with sides of 10 to 1M ids and universes of 40 to 100000 times the input size.
+// The sort dominates Merge and Gallop, and a bitset scan stays cheaper than that
+// sort until the universe is about 128 times the input. Past that, merging wins
+// for small and very large inputs, and hashing, which skips the sort, wins in
+// between. Galloping only pays off for small, lopsided inputs.
+SetStrategy chooseSetStrategy(size_t userSize, size_t mirrorSize, size_t universe) {
+    const size_t total = userSize + mirrorSize;
+    const size_t smaller = std::min(userSize, mirrorSize);
+    const size_t larger = std::max(userSize, mirrorSize);
+    if (universe <= 128 * total) return SetStrategy::Bitset;
+    if (total <= 4096) return smaller * 32 <= larger ? SetStrategy::Gallop : SetStrategy::Merge;
+    if (total <= 256 * 1024) return SetStrategy::Hash;
+    return SetStrategy::Merge;
+}
+
+ParseSession::IdList ParseSession::sortedCopy(const IdList &ids) {
+    IdList sorted(ids, &arena);
+    std::sort(sorted.begin(), sorted.end());
+    return sorted;
+}
+
+// First position in [from, end) whose id is >= value, found by doubling the step
+// from `from` and then binary searching the last step.
+static ParseSession::IdList::const_iterator gallop(ParseSession::IdList::const_iterator from,
+                                                   ParseSession::IdList::const_iterator end, NameId value) {
+    size_t step = 1;
+    auto low = from;
+    while (low != end) {
+        const size_t remaining = size_t(end - low);
+        auto probe = low + std::ptrdiff_t(std::min(step, remaining) - 1);
+        if (*probe >= value) return std::lower_bound(low, probe + 1, value);
+        low = probe + 1;
+        step *= 2;
+    }
+    return end;
+}
+
+ParseSession::Diff ParseSession::diff(const IdList &user, const IdList &mirror, SetStrategy strategy) {
+    if (strategy == SetStrategy::Auto) strategy = chooseSetStrategy(user.size(), mirror.size(), idCount());
+    lastStrategy = strategy;
+    Diff result{ IdList(&arena), IdList(&arena), IdList(&arena) };
+
+    switch (strategy) {
+    case SetStrategy::Bitset: {
+        const size_t words = size_t(idCount()) / 64 + 1;
+        std::pmr::vector<quint64> userBits(words, 0, &arena);
+        std::pmr::vector<quint64> mirrorBits(words, 0, &arena);
+        for (NameId id : user) userBits[id / 64] |= quint64(1) << (id % 64);
+        for (NameId id : mirror) mirrorBits[id / 64] |= quint64(1) << (id % 64);
+        auto collect = [](quint64 bits, size_t word, IdList &out) {
+            while (bits) {
+                out.push_back(NameId(word * 64 + qCountTrailingZeroBits(bits)));
+                bits &= bits - 1;
+            }
+        };
+        for (size_t w = 0; w < words; ++w) {
+            collect(mirrorBits[w] & ~userBits[w], w, result.missing);
+            collect(userBits[w] & ~mirrorBits[w], w, result.extra);
+            collect(userBits[w] & mirrorBits[w], w, result.shared);
+        }
+        break;
+    }
+    case SetStrategy::Hash: {
+        // No sorting at all; the name sort below is the only ordering pass.
+        std::pmr::unordered_set<NameId> held(user.begin(), user.end(), user.size(), std::hash<NameId>(),
+                                             std::equal_to<NameId>(), &arena);
+        std::pmr::unordered_set<NameId> wanted(mirror.begin(), mirror.end(), mirror.size(), std::hash<NameId>(),
+                                               std::equal_to<NameId>(), &arena);
+        for (NameId id : mirror) (held.count(id) ? result.shared : result.missing).push_back(id);
+        for (NameId id : user) {
+            if (!wanted.count(id)) result.extra.push_back(id);
+        }
+        break;
+    }
+    case SetStrategy::Merge: {
+        const IdList a = sortedCopy(mirror);
+        const IdList b = sortedCopy(user);
+        auto ai = a.cbegin();
+        auto bi = b.cbegin();
+        while (ai != a.cend() && bi != b.cend()) {
+            if (*ai < *bi) {
+                result.missing.push_back(*ai++);
+            } else if (*bi < *ai) {
+                result.extra.push_back(*bi++);
+            } else {
+                result.shared.push_back(*ai);
+                ++ai;
+                ++bi;
+            }
+        }
+        result.missing.insert(result.missing.end(), ai, a.cend());
+        result.extra.insert(result.extra.end(), bi, b.cend());
+        break;
+    }
+    case SetStrategy::Gallop:
+    case SetStrategy::Auto: {
+        const IdList a = sortedCopy(mirror);
+        const IdList b = sortedCopy(user);
+        auto ai = a.cbegin();
+        auto bi = b.cbegin();
+        // Runs present on one side only are skipped with a galloping search, so a
+        // small side costs O(small * log(large)) rather than a walk of the large one.
+        while (ai != a.cend() && bi != b.cend()) {
+            if (*ai < *bi) {
+                auto next = gallop(ai, a.cend(), *bi);
+                result.missing.insert(result.missing.end(), ai, next);
+                ai = next;
+            } else if (*bi < *ai) {
+                auto next = gallop(bi, b.cend(), *ai);
+                result.extra.insert(result.extra.end(), bi, next);
+                bi = next;
+            } else {
+                result.shared.push_back(*ai);
+                ++ai;
+                ++bi;
+            }
+        }
+        result.missing.insert(result.missing.end(), ai, a.cend());
+        result.extra.insert(result.extra.end(), bi, b.cend());
+        break;
+    }
+    }
+
+    sortByName(result.missing);
+    sortByName(result.extra);
+    sortByName(result.shared);
+    return result;
+}
+
+void ParseSession::sortByName(IdList &ids) const {
+    // Catalog ids are already in name order, so only uncatalogued names need comparing.
+    std::sort(ids.begin(), ids.end(), [this](NameId a, NameId b) {
+        if (a < catalogSize && b < catalogSize) return a < b;
+        return nameLess(name(a), name(b));
+    });
+}
+
+QStringView ParseSession::name(NameId id) const {
+    if (id < catalogSize) return QStringView(catalogSnapshot->names[qsizetype(id)]);
+    return (*localNames)[id - catalogSize];
+}
+
+QStringList ParseSession::names(const IdList &ids) const {
+    QStringList result;
+    result.reserve(qsizetype(ids.size()));
+    for (NameId id : ids) result << name(id).toString();
+    return result;
+}
@@ -0,0 +1,251 @@
+// Parsing, catalog and comparison core of the Permission Set Comparator, shared by
+// the desktop app and the language bindings. Depends on QtCore only.
+
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QSet>
+#include <QtCore/QHash>
+#include <QtCore/QDataStream>
+
+#include <QtCore/QStringView>
+#include <QtCore/QByteArrayView>
+#include <QtCore/QList>
+
+#include <memory>
+#include <functional>
+#include <memory_resource>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+// Case-insensitive multi-phrase matcher (Aho-Corasick) for the header and noise
+// phrases of Salesforce exports. One scan of a line reports every occurrence of
+// every phrase, so the cost per line does not grow with the number of phrases.
+class NoisePhraseMatcher {
+public:
+    enum Kind : quint8 {
+        Header,  // a token containing it, or a line that also has an Action, is a header row
+        Action,
+        Ignored, // a token containing it is skipped
+    };
+    struct Match {
+        const QChar *begin;
+        const QChar *end;
+        Kind kind;
+    };
+
+    // The built-in English phrases plus any extra ones, e.g. for localized UIs.
+    explicit NoisePhraseMatcher(const QStringList &extraHeaders = QStringList(),
+                                const QStringList &extraIgnored = QStringList());
+
+    // Appends the matches in `text`; they point into `text`.
+    void scan(QStringView text, std::pmr::vector<Match> &matches) const;
+
+private:
+    struct Output {
+        quint16 length;
+        Kind kind;
+    };
+
+    void add(const QString &phrase, Kind kind);
+    void build();
+    int wideStep(int state, char16_t c) const;
+
+    static constexpr int AsciiSize = 128;
+    std::vector<int> ascii;                               // full transition table for ASCII
+    std::vector<std::vector<std::pair<char16_t, int>>> wide; // trie edges for other characters
+    std::vector<int> fail;
+    std::vector<std::vector<Output>> outputs;
+};
+
+// The matcher extractPermissionName uses.
+const NoisePhraseMatcher &noisePhrases();
+// Replaces it with one that also knows `headerPhrases` and `ignoredPhrases`. Safe
+// while other threads are parsing; they keep the matcher they started the line with.
+void setExtraNoisePhrases(const QStringList &headerPhrases, const QStringList &ignoredPhrases);
+
+// Pasted-text parsing. Accepts tab, comma, multi-space and line separated lists and
+// skips Salesforce header rows, action words and assignment dates.
+QStringList tokenizeLine(const QString &rawLine);
+// "Add", "Del", "Delete" or "Remove" in any case: the action column of assignment
+// exports, which parsing skips.
+bool isActionWord(QStringView s);
+QString extractPermissionName(const QString &rawLine);
+// View-based forms of the above: tokens and the result point into `rawLine`, and
+// `tokens` and `matches` are scratch space that is reused from line to line.
+void tokenizeLine(QStringView rawLine, std::pmr::vector<QStringView> &tokens);
+QStringView extractPermissionName(QStringView rawLine, std::pmr::vector<QStringView> &tokens,
+                                  std::pmr::vector<NoisePhraseMatcher::Match> &matches);
+// Permission set names in first-seen order, without duplicates.
+QStringList extractPermissionNames(const QString &raw);
+QSet<QString> parsePermissions(const QString &raw);
+
+// Case-insensitive order used for every list of permission set names.
+bool nameLess(QStringView a, QStringView b);
+
+// Permission sets the mirror user has and the primary user lacks, case-insensitively sorted.
+QStringList missingPermissions(const QSet<QString> &userPerms, const QSet<QString> &mirrorPerms);
+
+// Interned permission set name; see ParseSession.
+using NameId = quint32;
+
+struct NameViewHash {
+    size_t operator()(QStringView s) const noexcept { return size_t(qHash(s)); }
+};
+
+// One row of the permission set catalog CSV.
+struct CatalogEntry {
+    QString id;
+    QString apiName;
+    QString name;
+    QString description;
+
+    bool operator==(const CatalogEntry &other) const {
+        return id == other.id && apiName == other.apiName
+            && name == other.name && description == other.description;
+    }
+    bool operator!=(const CatalogEntry &other) const { return !(*this == other); }
+};
+
+// Catalog index keyed by lower-cased permission set name. Published instances are
+// immutable and shared through CatalogSnapshot, so a reload can build the next index
+// off-thread while the GUI keeps reading the current one.
+struct PermissionCatalog {
+    QHash<QString, CatalogEntry> entries;
+    // Catalog names in nameLess order. A name's position is its interned id, so
+    // sorting catalog ids sorts them by name. Rebuilt by indexNames() whenever
+    // `entries` changes.
+    QStringList names;
+    std::unordered_map<QStringView, NameId, NameViewHash> nameIds; // views into `names`
+
+    void indexNames();
+
+    QString descriptionFor(const QString &name) const {
+        auto it = entries.constFind(name.toLower());
+        return it == entries.cend() ? QString() : it->description;
+    }
+
+    const CatalogEntry *find(const QString &name) const {
+        auto it = entries.constFind(name.toLower());
+        return it == entries.cend() ? nullptr : &it.value();
+    }
+};
+using CatalogSnapshot = std::shared_ptr<const PermissionCatalog>;
+
+// Text file ingestion. Excel saves CSVs as UTF-8 with or without a BOM, as UTF-16
+// with a BOM, or in the Windows ANSI code page. The encoding is sniffed once per
+// file: first a BOM, then the NUL-byte pattern of UTF-16 without one, then UTF-8
+// validation. Anything that is not valid UTF-8 is read as Windows-1252.
+enum class TextEncoding { Utf8, Utf16LE, Utf16BE, Windows1252 };
+
+TextEncoding detectEncoding(QByteArrayView bytes);
+QString decodeText(QByteArrayView bytes, TextEncoding *encoding = nullptr);
+// Reads and decodes a whole file, through a memory mapping where possible.
+bool readTextFile(const QString &path, QString &text, QString *error = nullptr);
+
+// Calls fn(QStringView) for each line of `text`, without its "\n" or "\r\n".
+template <typename Fn>
+void forEachLine(QStringView text, Fn &&fn) {
+    qsizetype start = 0;
+    while (start < text.size()) {
+        qsizetype end = text.indexOf(u'\n', start);
+        if (end < 0) end = text.size();
+        QStringView line = text.mid(start, end - start);
+        if (line.endsWith(u'\r')) line.chop(1);
+        fn(line);
+        start = end + 1;
+    }
+}
+
+QStringList splitCsvLine(QStringView line);
+PermissionCatalog parseCatalogCsv(const QString &path);
+// Same as parseCatalogCsv for CSV text that is already in memory.
+PermissionCatalog parseCatalogText(const QString &text);
+
+QDataStream &operator<<(QDataStream &out, const CatalogEntry &entry);
+QDataStream &operator>>(QDataStream &in, CatalogEntry &entry);
+
+// Binary snapshots sit next to the CSV they were built from and are only trusted
+// while the CSV's size and modification time still match the recorded ones.
+QString snapshotPath(const QString &csvPath);
+bool loadCatalogSnapshot(const QString &csvPath, PermissionCatalog &catalog);
+// Best effort: a read-only catalog folder simply means the CSV is parsed every time.
+void saveCatalogSnapshot(const QString &csvPath, const PermissionCatalog &catalog);
+// Loads from the snapshot when it is current, otherwise parses the CSV and refreshes it.
+PermissionCatalog loadCatalog(const QString &csvPath);
+
+struct ParsedFile {
+    QString path;
+    QStringList names;
+    QStringList missing; // filled for primary files of a batch comparison
+    QString error;
+};
+
+// Reads one user export through a memory mapping where the platform allows it.
+ParsedFile readPermissionFile(const QString &path);
+
+// How ParseSession compares two id lists. Auto picks one from the input sizes and
+// the number of interned ids, see chooseSetStrategy.
+enum class SetStrategy { Auto, Hash, Merge, Gallop, Bitset };
+
+SetStrategy chooseSetStrategy(size_t userSize, size_t mirrorSize, size_t universe);
+
+// Scratch state of one parse/compare cycle. Token views, names that are not in the
+// catalog, and intermediate id vectors are all allocated from a monotonic arena that
+// reset() releases in one step, so nothing is freed piecemeal after a compare.
+//
+// Names are interned: a catalog name keeps its catalog id, and any other name gets
+// the next id after the catalog's. Ids, views and lists returned by a session are
+// valid until its next reset().
+class ParseSession {
+public:
+    using IdList = std::pmr::vector<NameId>;
+    // Every id of either side, classified once. Each list is in nameLess order.
+    struct Diff {
+        IdList missing; // mirror has, user lacks
+        IdList extra;   // user has, mirror lacks
+        IdList shared;
+    };
+
+    explicit ParseSession(size_t initialBytes = 256 * 1024);
+    ParseSession(const ParseSession &) = delete;
+    ParseSession &operator=(const ParseSession &) = delete;
+
+    void reset(const CatalogSnapshot &catalog);
+
+    // Interned ids of the names in `text`, in first-seen order without duplicates.
+    // The text is kept alive until the next reset().
+    IdList parse(const QString &text);
+    // Both directions of the comparison in one pass, by the strategy chooseSetStrategy
+    // picks: a bitset AND/ANDNOT when the ids are dense, a galloping merge when one
+    // side is much smaller, a linear merge of the sorted ids, or hash lookups.
+    Diff diff(const IdList &user, const IdList &mirror, SetStrategy strategy = SetStrategy::Auto);
+    void sortByName(IdList &ids) const;
+
+    NameId idCount() const { return catalogSize + NameId(localNames->size()); }
+    bool isCatalogued(NameId id) const { return id < catalogSize; }
+    QStringView name(NameId id) const;
+    QStringList names(const IdList &ids) const;
+    const CatalogSnapshot &catalog() const { return catalogSnapshot; }
+    std::pmr::memory_resource *memory() { return &arena; }
+    // Strategy the last comparison actually used.
+    SetStrategy strategy() const { return lastStrategy; }
+
+private:
+    IdList sortedCopy(const IdList &ids);
+    NameId intern(QStringView name);
+    std::pmr::vector<quint8> &clearedMarks();
+
+    std::pmr::monotonic_buffer_resource arena;
+    CatalogSnapshot catalogSnapshot;
+    NameId catalogSize = 0;
+    SetStrategy lastStrategy = SetStrategy::Auto;
+    QList<QString> pinned;
+    std::optional<std::pmr::vector<QStringView>> tokens;
+    std::optional<std::pmr::vector<NoisePhraseMatcher::Match>> matches;
+    std::optional<std::pmr::vector<QStringView>> localNames;
+    std::optional<std::pmr::unordered_map<QStringView, NameId, NameViewHash>> localIds;
+    std::optional<std::pmr::vector<quint8>> marks;
+};
@@ -0,0 +1,116 @@
+// Work-stealing job scheduler. See permcalc_jobs.h.
+
+#include "permcalc_jobs.h"
+
+#include <QtCore/QThread>
+
+#include <algorithm>
+#include <deque>
+
+namespace {
+
+// The scheduler and queue a worker thread belongs to; unset on other threads.
+thread_local const JobScheduler *currentScheduler = nullptr;
+thread_local int currentQueue = -1;
+
+} // namespace
+
+struct JobScheduler::Queue {
+    std::mutex lock;
+    std::deque<Task> tasks[PriorityCount];
+
+    bool popBack(int priority, Task &task) {
+        std::lock_guard<std::mutex> guard(lock);
+        std::deque<Task> &deque = tasks[priority];
+        if (deque.empty()) return false;
+        task = std::move(deque.back());
+        deque.pop_back();
+        return true;
+    }
+
+    bool popFront(int priority, Task &task) {
+        std::lock_guard<std::mutex> guard(lock);
+        std::deque<Task> &deque = tasks[priority];
+        if (deque.empty()) return false;
+        task = std::move(deque.front());
+        deque.pop_front();
+        return true;
+    }
+};
+
+JobScheduler &JobScheduler::instance() {
+    // Never destroyed: its workers may still be running jobs while the process exits.
+    static JobScheduler *const scheduler = new JobScheduler;
+    return *scheduler;
+}
+
+JobScheduler::JobScheduler(int workers) {
+    if (workers <= 0) workers = std::max(1, QThread::idealThreadCount());
+    for (int i = 0; i <= workers; ++i) queues.push_back(std::make_unique<Queue>());
+    for (int i = 0; i < workers; ++i) threads.emplace_back([this, i] { workerLoop(i); });
+}
+
+JobScheduler::~JobScheduler() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &thread : threads) thread.join();
+}
+
+JobScheduler::Queue &JobScheduler::ownQueue() {
+    return *queues[currentScheduler == this ? currentQueue : int(queues.size()) - 1];
+}
+
+void JobScheduler::submit(JobPriority priority, Task task) {
+    {
+        Queue &queue = ownQueue();
+        std::lock_guard<std::mutex> guard(queue.lock);
+        queue.tasks[int(priority)].push_back(std::move(task));
+    }
+    queued.fetch_add(1, std::memory_order_release);
+    // Taking the lock orders this after a worker's check of `queued`, so a worker
+    // about to sleep either sees the task or gets the notification.
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wake.notify_one();
+}
+
+bool JobScheduler::takeTask(Task &task) {
+    if (queued.load(std::memory_order_acquire) == 0) return false;
+    const int count = int(queues.size());
+    const int own = currentScheduler == this ? currentQueue : count - 1;
+    for (int priority = 0; priority < PriorityCount; ++priority) {
+        // Own tasks newest first, everyone else's oldest first.
+        if (queues[own]->popBack(priority, task)) return true;
+        for (int i = 1; i < count; ++i) {
+            if (queues[(own + i) % count]->popFront(priority, task)) return true;
+        }
+    }
+    return false;
+}
+
+bool JobScheduler::runPendingTask() {
+    Task task;
+    if (!takeTask(task)) return false;
+    queued.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+void JobScheduler::waitFor(const QFuture<void> &future) {
+    while (!future.isFinished()) {
+        if (!runPendingTask()) QThread::usleep(100);
+    }
+}
+
+void JobScheduler::workerLoop(int index) {
+    currentScheduler = this;
+    currentQueue = index;
+    for (;;) {
+        if (runPendingTask()) continue;
+        std::unique_lock<std::mutex> lock(sleepLock);
+        wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        if (stopping) return;
+    }
+}
@@ -0,0 +1,183 @@
+// Job system for the app's background work. Each worker thread owns a deque per
+// priority: it pushes and pops its own subtasks at the back and, when it runs dry,
+// steals from the front of the others', where the largest pieces of split work sit.
+// Tasks submitted from other threads, such as the GUI thread, go to a shared
+// injection deque. Workers always take the highest priority task anywhere before a
+// lower one, so queued interactive work overtakes batch work at the next task
+// boundary.
+//
+// Jobs hand back QFutures, so callers watch them with QFutureWatcher or
+// QFuture::then as before. Cancelling the future is the cancellation token, which
+// jobs poll through their QPromise, and the promise's progress reaches the watcher's
+// progress signals.
+
+#pragma once
+
+#include <QtCore/QFuture>
+#include <QtCore/QPromise>
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+enum class JobPriority {
+    Interactive, // the user is waiting on it right now
+    Normal,      // started by the user, with progress shown
+    Background,  // unattended work such as the watch folder
+};
+
+class JobScheduler {
+public:
+    using Task = std::function<void()>;
+
+    // The scheduler the app uses, with one worker per core.
+    static JobScheduler &instance();
+
+    explicit JobScheduler(int workers = 0); // 0 means one per core
+    ~JobScheduler();
+    JobScheduler(const JobScheduler &) = delete;
+    JobScheduler &operator=(const JobScheduler &) = delete;
+
+    int workerCount() const { return int(threads.size()); }
+
+    void submit(JobPriority priority, Task task);
+
+    // fn() on a worker. The future counts as running from the start, so a watcher's
+    // isRunning() is true at once, and cancelling it before a worker picks it up
+    // skips the job.
+    template <typename Fn>
+    auto run(JobPriority priority, Fn fn) -> QFuture<std::invoke_result_t<Fn>>;
+
+    // fn(QPromise<T> &) on a worker, for jobs that poll isCanceled(), report progress
+    // or add several results.
+    template <typename T, typename Fn>
+    QFuture<T> runWithPromise(JobPriority priority, Fn fn);
+
+    // fn(item) for each item. The range is split in halves as it runs, so idle workers
+    // steal large pieces, and every item is a task of its own. The result of item i
+    // is reported at index i (QFutureWatcher::resultReadyAt), the progress value is
+    // the number of items done, and cancelling skips the items not started yet.
+    template <typename Container, typename Fn>
+    auto mapped(JobPriority priority, Container items, Fn fn)
+        -> QFuture<std::invoke_result_t<Fn, const typename Container::value_type &>>;
+
+    // mapped() that waits, helping with queued tasks meanwhile; results in item order.
+    template <typename Container, typename Fn>
+    auto blockingMapped(JobPriority priority, Container items, Fn fn)
+        -> QList<std::invoke_result_t<Fn, const typename Container::value_type &>>;
+
+    // Runs queued tasks on the calling thread until `future` finishes, so a job that
+    // waits for its own subtasks cannot leave the pool without a free worker.
+    void waitFor(const QFuture<void> &future);
+
+    // Runs one queued task on the calling thread; false when nothing is queued.
+    bool runPendingTask();
+
+private:
+    static constexpr int PriorityCount = 3;
+    struct Queue;
+
+    template <typename State>
+    void mapRange(const std::shared_ptr<State> &state, qsizetype begin, qsizetype end);
+
+    Queue &ownQueue();
+    bool takeTask(Task &task);
+    void workerLoop(int index);
+
+    std::vector<std::unique_ptr<Queue>> queues; // one per worker, then the injection queue
+    std::vector<std::thread> threads;
+    std::atomic<int> queued{ 0 };
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    bool stopping = false; // guarded by sleepLock
+};
+
+template <typename Fn>
+auto JobScheduler::run(JobPriority priority, Fn fn) -> QFuture<std::invoke_result_t<Fn>> {
+    using R = std::invoke_result_t<Fn>;
+    return runWithPromise<R>(priority, [fn = std::move(fn)](QPromise<R> &promise) mutable {
+        if constexpr (std::is_void_v<R>) {
+            Q_UNUSED(promise);
+            fn();
+        } else {
+            promise.addResult(fn());
+        }
+    });
+}
+
+template <typename T, typename Fn>
+QFuture<T> JobScheduler::runWithPromise(JobPriority priority, Fn fn) {
+    auto promise = std::make_shared<QPromise<T>>();
+    QFuture<T> future = promise->future();
+    promise->start();
+    submit(priority, [promise, fn = std::move(fn)]() mutable {
+        if (!promise->isCanceled()) fn(*promise);
+        promise->finish();
+    });
+    return future;
+}
+
+template <typename Container, typename Fn>
+auto JobScheduler::mapped(JobPriority priority, Container items, Fn fn)
+    -> QFuture<std::invoke_result_t<Fn, const typename Container::value_type &>> {
+    using R = std::invoke_result_t<Fn, const typename Container::value_type &>;
+    struct State {
+        State(Container items, Fn fn, JobPriority priority)
+            : items(std::move(items)), fn(std::move(fn)), priority(priority) {}
+
+        const Container items;
+        Fn fn;
+        const JobPriority priority;
+        QPromise<R> promise;
+        std::mutex report; // guards promise updates and `done`
+        qsizetype done = 0;
+    };
+    auto state = std::make_shared<State>(std::move(items), std::move(fn), priority);
+    const qsizetype count = qsizetype(std::size(state->items));
+
+    QFuture<R> future = state->promise.future();
+    state->promise.start();
+    state->promise.setProgressRange(0, int(count));
+    if (count == 0) {
+        state->promise.finish();
+        return future;
+    }
+    submit(priority, [this, state, count] { mapRange(state, 0, count); });
+    return future;
+}
+
+template <typename State>
+void JobScheduler::mapRange(const std::shared_ptr<State> &state, qsizetype begin, qsizetype end) {
+    // Leave the upper halves for this worker's deque, where idle workers steal them,
+    // and keep the first item.
+    while (end - begin > 1) {
+        const qsizetype middle = begin + (end - begin) / 2;
+        submit(state->priority, [this, state, middle, end] { mapRange(state, middle, end); });
+        end = middle;
+    }
+
+    const qsizetype count = qsizetype(std::size(state->items));
+    if (!state->promise.isCanceled()) {
+        auto result = state->fn(state->items[begin]);
+        std::lock_guard<std::mutex> guard(state->report);
+        state->promise.addResult(std::move(result), int(begin));
+    }
+    std::lock_guard<std::mutex> guard(state->report);
+    state->promise.setProgressValue(int(++state->done));
+    if (state->done == count) state->promise.finish();
+}
+
+template <typename Container, typename Fn>
+auto JobScheduler::blockingMapped(JobPriority priority, Container items, Fn fn)
+    -> QList<std::invoke_result_t<Fn, const typename Container::value_type &>> {
+    auto future = mapped(priority, std::move(items), std::move(fn));
+    waitFor(QFuture<void>(future));
+    return future.results();
+}
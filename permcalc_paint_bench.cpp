@@ -0,0 +1,240 @@
+// Paint benchmark for the result table. Renders a QTableView of synthetic results
+// twice, once under the style sheet the app used to install and once under the
+// palette/proxy-style theme with ResultRowDelegate, and times:
+//
+//   scroll  paint of one viewport while paging through the whole table
+//   resize  re-layout plus paint after the view's width changes
+//
+//   permcalc_paint_bench [--rows N] [--repeat N] [--json FILE]
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise. Results go
+// to stdout as a table, and with --json as {"benchmarks": [{name, unit, samples}]}.
+
+#include "permcalc_bench.h"
+#include "permcalc_theme.h"
+
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QHeaderView>
+#include <QtWidgets/QScrollBar>
+#include <QtCore/QAbstractTableModel>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QTextStream>
+#include <QtGui/QBrush>
+#include <QtGui/QFont>
+#include <QtGui/QImage>
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// The style sheet applyStyles() installed before the theme, kept for comparison.
+const char *const LegacyStyleSheet = R"(
+    QMainWindow {
+        background-color: #f0f2f5;
+    }
+    QWidget {
+        font-family: "Segoe UI", sans-serif;
+        font-size: 14px;
+        color: #1c1e21;
+    }
+    QLabel#HeaderLabel {
+        font-size: 28px;
+        font-weight: 700;
+        color: #1c1e21;
+        margin-bottom: 10px;
+    }
+    QGroupBox {
+        background-color: #ffffff;
+        border: 1px solid #dddfe2;
+        border-radius: 8px;
+        margin-top: 24px;
+        font-size: 14px;
+        font-weight: 600;
+        color: #4b4f56;
+    }
+    QGroupBox::title {
+        subcontrol-origin: margin;
+        subcontrol-position: top left;
+        left: 12px;
+        padding: 0 8px;
+    }
+    QPlainTextEdit {
+        border: 1px solid #ccd0d5;
+        border-radius: 6px;
+        padding: 10px;
+        background-color: #f5f6f7;
+        font-family: "Consolas", "Courier New", monospace;
+        font-size: 13px;
+    }
+    QPlainTextEdit:focus {
+        background-color: #ffffff;
+        border: 1px solid #1877f2;
+    }
+    QListView {
+        border: 1px solid #ccd0d5;
+        border-radius: 6px;
+        background-color: #f5f6f7;
+        font-family: "Consolas", "Courier New", monospace;
+        font-size: 13px;
+    }
+    QPushButton {
+        background-color: #1877f2;
+        color: #ffffff;
+        border: none;
+        border-radius: 6px;
+        font-size: 16px;
+        font-weight: 600;
+        padding: 12px;
+    }
+    QPushButton:hover {
+        background-color: #166fe5;
+    }
+    QPushButton:pressed {
+        background-color: #155db5;
+    }
+    QPushButton#SecondaryButton {
+        background-color: #e4e6eb;
+        color: #1c1e21;
+        padding: 12px 24px;
+    }
+    QPushButton#SecondaryButton:hover {
+        background-color: #d8dadf;
+    }
+    QPushButton:disabled {
+        background-color: #bcc0c4;
+        color: #f0f2f5;
+    }
+    QTableView {
+        border: 1px solid #ccd0d5;
+        border-radius: 6px;
+        background-color: #ffffff;
+        alternate-background-color: #f9fafb;
+        font-family: "Segoe UI", sans-serif;
+        font-size: 13px;
+        color: #1c1e21;
+        outline: none;
+    }
+    QHeaderView::section {
+        background-color: #f0f2f5;
+        padding: 8px;
+        border: none;
+        border-bottom: 1px solid #dddfe2;
+        font-weight: 600;
+        color: #4b4f56;
+    }
+    QTableView::item {
+        padding: 8px;
+        border-bottom: 1px solid #f0f2f5;
+    }
+)";
+
+// Looks like the comparison results: bold red names, grey descriptions.
+class SyntheticResults : public QAbstractTableModel {
+public:
+    explicit SyntheticResults(int rows) : rows(rows) {}
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override { return parent.isValid() ? 0 : rows; }
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override { return parent.isValid() ? 0 : 2; }
+
+    QVariant data(const QModelIndex &index, int role) const override {
+        switch (role) {
+        case Qt::DisplayRole:
+            return index.column() == 0
+                ? QString("Permission_Set_%1").arg(index.row(), 6, 10, QChar('0'))
+                : QString("Grants access to feature area %1 for support and operations users").arg(index.row() % 97);
+        case Qt::FontRole:
+            if (index.column() == 0) {
+                QFont font;
+                font.setBold(true);
+                return font;
+            }
+            return QVariant();
+        case Qt::ForegroundRole:
+            return QBrush(QColor(index.column() == 0 ? "#c53030" : "#4b4f56"));
+        default:
+            return QVariant();
+        }
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override {
+        if (orientation != Qt::Horizontal || role != Qt::DisplayRole) return QVariant();
+        return section == 0 ? QString("Permission Set") : QString("Description");
+    }
+
+private:
+    int rows;
+};
+
+void configureView(QTableView &view, bool themed) {
+    view.verticalHeader()->setVisible(false);
+    view.verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    view.horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    view.setShowGrid(false);
+    view.setAlternatingRowColors(true);
+    view.setSelectionMode(QAbstractItemView::NoSelection);
+    if (themed) {
+        view.verticalHeader()->setDefaultSectionSize(ResultRowDelegate::RowHeight);
+        view.setItemDelegate(new ResultRowDelegate(&view));
+    }
+    view.resize(820, 600);
+}
+
+void runMode(QApplication &app, bool themed, int rows, int repeat, std::vector<Benchmark> &results) {
+    const QString mode = themed ? "theme" : "stylesheet";
+    if (themed) {
+        app.setStyleSheet(QString());
+        applyPermCalcTheme(app);
+    } else {
+        app.setStyleSheet(QString::fromUtf8(LegacyStyleSheet));
+    }
+
+    SyntheticResults model(rows);
+    QTableView view;
+    view.setModel(&model);
+    configureView(view, themed);
+    view.show();
+    QCoreApplication::processEvents();
+
+    QImage frame(view.viewport()->size().expandedTo(QSize(1024, 600)), QImage::Format_ARGB32_Premultiplied);
+    Benchmark scroll{ QString("paint/%1/scroll_%2_rows").arg(mode).arg(rows), "us/frame", {} };
+    Benchmark resize{ QString("paint/%1/resize_%2_rows").arg(mode).arg(rows), "us/resize", {} };
+    scrollPass(view, frame); // warm caches and fonts
+    for (int i = 0; i < repeat; ++i) {
+        view.verticalScrollBar()->setValue(0);
+        scroll.samples.push_back(scrollPass(view, frame));
+        resize.samples.push_back(resizePass(view, view, frame, { 640, 900, 760, 1024, 820 }));
+    }
+    results.push_back(std::move(scroll));
+    results.push_back(std::move(resize));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Result table paint benchmark: style sheet versus theme.");
+    parser.addHelpOption();
+    parser.addOption({ "rows", "Rows in the table.", "N", "10000" });
+    parser.addOption({ "repeat", "Measured passes per benchmark.", "N", "10" });
+    parser.addOption({ "json", "Also write the samples as JSON to FILE.", "FILE" });
+    parser.process(app);
+    const int rows = std::max(1, parser.value("rows").toInt());
+    const int repeat = std::max(1, parser.value("repeat").toInt());
+
+    std::vector<Benchmark> results;
+    runMode(app, false, rows, repeat, results);
+    runMode(app, true, rows, repeat, results);
+
+    printBenchmarks(results);
+    QString error;
+    if (parser.isSet("json") && !writeBenchmarkJson(parser.value("json"), results, &error)) {
+        QTextStream(stdout) << "Cannot write " << parser.value("json") << ": " << error << '\n';
+        return 1;
+    }
+    return 0;
+}
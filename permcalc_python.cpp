@@ -0,0 +1,362 @@
+// CPython extension exposing the comparator core to automation scripts:
+//
+//   import permcalc
+//   names = permcalc.parse_permissions(open("user.txt", "rb").read())
+//   catalog = permcalc.load_catalog("Permission Sets.csv")
+//   catalog.description("View Setup and Configuration")
+//   missing = permcalc.bulk_diff([user_a, user_b], mirror)
+//
+// Text arguments are str or any object exporting a contiguous byte buffer (bytes,
+// bytearray, memoryview, NumPy uint8 arrays) holding UTF-8, UTF-16 or Windows-1252
+// text. The buffers are read in place and the GIL is released while parsing and
+// comparing.
+// Build with -DPERMCALC_BUILD_PYTHON=ON (see CMakeLists.txt).
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "permcalc_core.h"
+
+#include <QtCore/QFileInfo>
+#include <QtCore/QThreadPool>
+
+#include <cerrno>
+#include <memory>
+#include <vector>
+
+namespace {
+
+// A str or bytes-like argument, held for the duration of one call. It keeps its own
+// reference to the object, so the text stays valid while the GIL is released even
+// if the caller's container drops the object meanwhile.
+class TextArg {
+public:
+    TextArg() = default;
+    TextArg(const TextArg &) = delete;
+    TextArg &operator=(const TextArg &) = delete;
+    // Must be destroyed with the GIL held.
+    ~TextArg() {
+        if (hasBuffer) PyBuffer_Release(&view);
+        Py_XDECREF(owner);
+    }
+
+    // Must be called with the GIL held; sets a Python error on failure.
+    bool bind(PyObject *obj) {
+        Py_INCREF(obj);
+        owner = obj;
+        if (PyUnicode_Check(obj)) {
+            Py_ssize_t size = 0;
+            data = PyUnicode_AsUTF8AndSize(obj, &size);
+            length = size;
+            return data != nullptr;
+        }
+        if (PyObject_GetBuffer(obj, &view, PyBUF_SIMPLE) != 0) return false;
+        hasBuffer = true;
+        data = static_cast<const char *>(view.buf);
+        length = view.len;
+        return true;
+    }
+
+    // Safe without the GIL: the object is referenced by this TextArg.
+    // Buffers are raw file contents, so their encoding is detected like a file's.
+    QString decode() const {
+        if (hasBuffer) return decodeText(QByteArrayView(data, qsizetype(length)));
+        return QString::fromUtf8(data, qsizetype(length));
+    }
+
+private:
+    PyObject *owner = nullptr;
+    Py_buffer view{};
+    bool hasBuffer = false;
+    const char *data = nullptr;
+    Py_ssize_t length = 0;
+};
+
+PyObject *toPyString(const QString &value) {
+    const QByteArray utf8 = value.toUtf8();
+    return PyUnicode_FromStringAndSize(utf8.constData(), utf8.size());
+}
+
+PyObject *toPyList(const QStringList &values) {
+    PyObject *list = PyList_New(values.size());
+    if (!list) return nullptr;
+    for (qsizetype i = 0; i < values.size(); ++i) {
+        PyObject *item = toPyString(values[i]);
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+bool toQString(PyObject *obj, QString &out) {
+    TextArg arg;
+    if (!arg.bind(obj)) return false;
+    out = arg.decode();
+    return true;
+}
+
+// permcalc.Catalog
+
+struct CatalogObject {
+    PyObject_HEAD
+    PermissionCatalog *catalog;
+};
+
+PyTypeObject *CatalogType = nullptr;
+
+void Catalog_dealloc(PyObject *self) {
+    PyTypeObject *type = Py_TYPE(self);
+    delete reinterpret_cast<CatalogObject *>(self)->catalog;
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+const PermissionCatalog *catalogOf(PyObject *self) {
+    const PermissionCatalog *catalog = reinterpret_cast<CatalogObject *>(self)->catalog;
+    if (!catalog) PyErr_SetString(PyExc_RuntimeError, "Catalog objects are created with permcalc.load_catalog()");
+    return catalog;
+}
+
+Py_ssize_t Catalog_len(PyObject *self) {
+    const PermissionCatalog *catalog = catalogOf(self);
+    return catalog ? Py_ssize_t(catalog->entries.size()) : -1;
+}
+
+int Catalog_contains(PyObject *self, PyObject *key) {
+    const PermissionCatalog *catalog = catalogOf(self);
+    QString name;
+    if (!catalog || !toQString(key, name)) return -1;
+    return catalog->find(name) != nullptr;
+}
+
+PyObject *Catalog_description(PyObject *self, PyObject *arg) {
+    const PermissionCatalog *catalog = catalogOf(self);
+    QString name;
+    if (!catalog || !toQString(arg, name)) return nullptr;
+    const CatalogEntry *entry = catalog->find(name);
+    if (!entry) Py_RETURN_NONE;
+    return toPyString(entry->description);
+}
+
+PyObject *Catalog_entry(PyObject *self, PyObject *arg) {
+    const PermissionCatalog *catalog = catalogOf(self);
+    QString name;
+    if (!catalog || !toQString(arg, name)) return nullptr;
+    const CatalogEntry *entry = catalog->find(name);
+    if (!entry) Py_RETURN_NONE;
+
+    PyObject *dict = PyDict_New();
+    if (!dict) return nullptr;
+    const std::pair<const char *, const QString *> fields[] = {
+        { "id", &entry->id },
+        { "api_name", &entry->apiName },
+        { "name", &entry->name },
+        { "description", &entry->description },
+    };
+    for (const auto &field : fields) {
+        PyObject *value = toPyString(*field.second);
+        if (!value || PyDict_SetItemString(dict, field.first, value) != 0) {
+            Py_XDECREF(value);
+            Py_DECREF(dict);
+            return nullptr;
+        }
+        Py_DECREF(value);
+    }
+    return dict;
+}
+
+PyMethodDef CatalogMethods[] = {
+    { "description", Catalog_description, METH_O,
+      "description(name) -> str | None\n\nDescription of a permission set, matched case-insensitively." },
+    { "entry", Catalog_entry, METH_O,
+      "entry(name) -> dict | None\n\nThe catalog row (id, api_name, name, description) of a permission set." },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+PyType_Slot CatalogSlots[] = {
+    { Py_tp_dealloc, reinterpret_cast<void *>(Catalog_dealloc) },
+    { Py_tp_methods, CatalogMethods },
+    { Py_sq_length, reinterpret_cast<void *>(Catalog_len) },
+    { Py_sq_contains, reinterpret_cast<void *>(Catalog_contains) },
+    { Py_tp_doc, const_cast<char *>("Permission set catalog loaded with permcalc.load_catalog().") },
+    { 0, nullptr }
+};
+
+PyType_Spec CatalogSpec = {
+    "permcalc.Catalog",
+    sizeof(CatalogObject),
+    0,
+#ifdef Py_TPFLAGS_DISALLOW_INSTANTIATION
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+#else
+    Py_TPFLAGS_DEFAULT,
+#endif
+    CatalogSlots
+};
+
+// Module functions
+
+PyObject *parse_permissions(PyObject *, PyObject *arg) {
+    TextArg text;
+    if (!text.bind(arg)) return nullptr;
+    QStringList names;
+    Py_BEGIN_ALLOW_THREADS
+    names = extractPermissionNames(text.decode());
+    Py_END_ALLOW_THREADS
+    return toPyList(names);
+}
+
+PyObject *load_catalog(PyObject *, PyObject *arg) {
+    QString path;
+    if (!toQString(arg, path)) return nullptr;
+    // Parsed without touching the binary snapshot, so scripts never write next to
+    // the catalog. The checks give the usual errno for the common failures.
+    const QFileInfo file(path);
+    if (!file.exists() || file.isDir() || !file.isReadable()) {
+        errno = !file.exists() ? ENOENT : file.isDir() ? EISDIR : EACCES;
+        return PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, arg);
+    }
+    auto catalog = std::make_unique<PermissionCatalog>();
+    QString error;
+    bool read = false;
+    Py_BEGIN_ALLOW_THREADS
+    QString text;
+    read = readTextFile(path, text, &error);
+    if (read) *catalog = parseCatalogText(text);
+    Py_END_ALLOW_THREADS
+    if (!read) {
+        PyObject *exc = Py_BuildValue("(isO)", EIO, error.toUtf8().constData(), arg);
+        if (exc) {
+            PyErr_SetObject(PyExc_OSError, exc);
+            Py_DECREF(exc);
+        }
+        return nullptr;
+    }
+
+    CatalogObject *self = PyObject_New(CatalogObject, CatalogType);
+    if (!self) return nullptr;
+    self->catalog = catalog.release();
+    return reinterpret_cast<PyObject *>(self);
+}
+
+PyObject *missing_permissions(PyObject *, PyObject *args) {
+    PyObject *userObj = nullptr;
+    PyObject *mirrorObj = nullptr;
+    if (!PyArg_ParseTuple(args, "OO:missing_permissions", &userObj, &mirrorObj)) return nullptr;
+    TextArg user;
+    TextArg mirror;
+    if (!user.bind(userObj) || !mirror.bind(mirrorObj)) return nullptr;
+    QStringList missing;
+    Py_BEGIN_ALLOW_THREADS
+    missing = missingPermissions(parsePermissions(user.decode()), parsePermissions(mirror.decode()));
+    Py_END_ALLOW_THREADS
+    return toPyList(missing);
+}
+
+// Compares every primary user against one mirror user on a private thread pool.
+PyObject *bulk_diff(PyObject *, PyObject *args) {
+    PyObject *primariesObj = nullptr;
+    PyObject *mirrorObj = nullptr;
+    if (!PyArg_ParseTuple(args, "OO:bulk_diff", &primariesObj, &mirrorObj)) return nullptr;
+
+    PyObject *primaries = PySequence_Fast(primariesObj, "bulk_diff() expects a sequence of primary users");
+    if (!primaries) return nullptr;
+    const Py_ssize_t count = PySequence_Fast_GET_SIZE(primaries);
+    std::vector<std::unique_ptr<TextArg>> texts;
+    texts.reserve(size_t(count));
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        texts.push_back(std::make_unique<TextArg>());
+        if (!texts.back()->bind(PySequence_Fast_GET_ITEM(primaries, i))) {
+            texts.clear();
+            Py_DECREF(primaries);
+            return nullptr;
+        }
+    }
+    TextArg mirror;
+    if (!mirror.bind(mirrorObj)) {
+        texts.clear();
+        Py_DECREF(primaries);
+        return nullptr;
+    }
+
+    std::vector<QStringList> results(static_cast<size_t>(count));
+    Py_BEGIN_ALLOW_THREADS
+    const QSet<QString> mirrorPerms = parsePermissions(mirror.decode());
+    QThreadPool pool;
+    for (size_t i = 0; i < results.size(); ++i) {
+        pool.start([&texts, &results, &mirrorPerms, i]() {
+            results[i] = missingPermissions(parsePermissions(texts[i]->decode()), mirrorPerms);
+        });
+    }
+    pool.waitForDone();
+    Py_END_ALLOW_THREADS
+
+    // Buffers and references must be released with the GIL held.
+    texts.clear();
+    Py_DECREF(primaries);
+
+    PyObject *list = PyList_New(count);
+    if (!list) return nullptr;
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        PyObject *item = toPyList(results[size_t(i)]);
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    return list;
+}
+
+PyMethodDef ModuleMethods[] = {
+    { "parse_permissions", parse_permissions, METH_O,
+      "parse_permissions(text) -> list[str]\n\n"
+      "Permission set names found in pasted or exported text, in first-seen order." },
+    { "load_catalog", load_catalog, METH_O,
+      "load_catalog(path) -> Catalog\n\n"
+      "Parses a permission set catalog CSV. Unlike the app, it neither reads nor\n"
+      "writes the binary snapshot next to the file.\n"
+      "Raises OSError if the file does not exist or cannot be read." },
+    { "missing_permissions", missing_permissions, METH_VARARGS,
+      "missing_permissions(user, mirror) -> list[str]\n\n"
+      "Permission sets in the mirror text that the user text lacks, sorted." },
+    { "bulk_diff", bulk_diff, METH_VARARGS,
+      "bulk_diff(users, mirror) -> list[list[str]]\n\n"
+      "missing_permissions() for each user against one mirror, computed in parallel." },
+    { nullptr, nullptr, 0, nullptr }
+};
+
+PyModuleDef ModuleDef = {
+    PyModuleDef_HEAD_INIT,
+    "permcalc",
+    "Native Salesforce permission set parsing and comparison.",
+    -1,
+    ModuleMethods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr
+};
+
+} // namespace
+
+PyMODINIT_FUNC PyInit_permcalc() {
+    PyObject *module = PyModule_Create(&ModuleDef);
+    if (!module) return nullptr;
+
+    CatalogType = reinterpret_cast<PyTypeObject *>(PyType_FromSpec(&CatalogSpec));
+    if (!CatalogType) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    Py_INCREF(CatalogType);
+    if (PyModule_AddObject(module, "Catalog", reinterpret_cast<PyObject *>(CatalogType)) != 0) {
+        Py_DECREF(CatalogType);
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
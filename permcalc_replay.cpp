@@ -0,0 +1,133 @@
+// Replays recorded comparison sessions (permcalc_session.h) against the real window
+// and times them, so a corpus of real-world sessions can serve as a regression
+// benchmark. Each repeat opens a fresh window and runs every event of the session
+// in order, without the pauses between them. It reports:
+//
+//   total           the whole session
+//   event/<type>    all events of one type (paste, edit, clear, edit_as_text, compare)
+//   stage/<stage>   all time in one instrumented stage (StageScope), e.g.
+//                   comparePermissions, table population, sanitizeText, paste
+//
+//   permcalc_replay [--repeat N] [--json FILE] SESSION.jsonl...
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise. Results go
+// to stdout as a table, and with --json as {"benchmarks": [{name, unit, samples}]}.
+
+#include "permcalc_bench.h"
+#include "permcalc_session.h"
+#include "permcalc_watchdog.h"
+#include "permcalc_window.h"
+
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QMainWindow>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMap>
+
+#include <memory>
+
+namespace {
+
+// Nanoseconds per stage in the current repeat; filled by the stage timing sink.
+QMap<QString, qint64> stageTotals;
+
+void addStageTime(const char *stage, qint64 nanoseconds) {
+    stageTotals[QString::fromLatin1(stage)] += nanoseconds;
+}
+
+const char *eventName(SessionEvent::Type type) {
+    switch (type) {
+    case SessionEvent::Type::Paste: return "paste";
+    case SessionEvent::Type::Edit: return "edit";
+    case SessionEvent::Type::Clear: return "clear";
+    case SessionEvent::Type::EditAsText: return "edit_as_text";
+    case SessionEvent::Type::Compare: return "compare";
+    }
+    return "unknown";
+}
+
+// Samples by name, in the order names first appear.
+struct SampleTable {
+    std::vector<Benchmark> results;
+
+    void add(const QString &name, double ms) {
+        for (Benchmark &b : results) {
+            if (b.name == name) {
+                b.samples.push_back(ms);
+                return;
+            }
+        }
+        results.push_back({ name, "ms", { ms } });
+    }
+};
+
+void replaySession(const QString &name, const std::vector<SessionEvent> &events, int repeat,
+                   std::vector<Benchmark> &results) {
+    SampleTable table;
+    const QString prefix = QString("replay/%1/").arg(name);
+    for (int i = 0; i < repeat; ++i) {
+        std::unique_ptr<QMainWindow> window(createPermissionSetCalculator());
+        window->resize(900, 800);
+        window->show();
+        QCoreApplication::processEvents();
+        stageTotals.clear();
+
+        QMap<QString, qint64> eventTotals;
+        QElapsedTimer total;
+        total.start();
+        for (const SessionEvent &event : events) {
+            QElapsedTimer timer;
+            timer.start();
+            replaySessionEvent(window.get(), event);
+            // Highlighting, list updates and repaints the event queued.
+            QCoreApplication::processEvents();
+            eventTotals[QLatin1String(eventName(event.type))] += timer.nsecsElapsed();
+        }
+        table.add(prefix + "total", total.nsecsElapsed() / 1e6);
+        for (auto it = eventTotals.cbegin(); it != eventTotals.cend(); ++it) {
+            table.add(prefix + "event/" + it.key(), it.value() / 1e6);
+        }
+        for (auto it = stageTotals.cbegin(); it != stageTotals.cend(); ++it) {
+            table.add(prefix + "stage/" + it.key(), it.value() / 1e6);
+        }
+    }
+    for (Benchmark &b : table.results) results.push_back(std::move(b));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replays recorded comparison sessions against the app window and times them.");
+    parser.addHelpOption();
+    parser.addOption({ "repeat", "Measured replays per session.", "N", "5" });
+    parser.addOption({ "json", "Also write the samples as JSON to FILE.", "FILE" });
+    parser.addPositionalArgument("sessions", "Session recordings (.jsonl) to replay.", "SESSION...");
+    parser.process(app);
+    const int repeat = std::max(1, parser.value("repeat").toInt());
+    if (parser.positionalArguments().isEmpty()) parser.showHelp(1);
+
+    setStageTimingSink(addStageTime);
+    std::vector<Benchmark> results;
+    QString error;
+    for (const QString &path : parser.positionalArguments()) {
+        std::vector<SessionEvent> events;
+        if (!readSession(path, events, &error)) {
+            QTextStream(stdout) << "Cannot read " << path << ": " << error << '\n';
+            return 1;
+        }
+        replaySession(QFileInfo(path).completeBaseName(), events, repeat, results);
+    }
+    setStageTimingSink(nullptr);
+
+    printBenchmarks(results);
+    if (parser.isSet("json") && !writeBenchmarkJson(parser.value("json"), results, &error)) {
+        QTextStream(stdout) << "Cannot write " << parser.value("json") << ": " << error << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Bounded lock-free queue for handing batches of results from worker threads to the
+// GUI thread (Vyukov's bounded MPMC queue). Every slot carries a sequence number that
+// tells a producer whether the slot is free for its ticket and the consumer whether
+// it has been filled, so a push or pop is one CAS on a shared index plus one release
+// store, and neither side ever blocks the other. Any number of threads may push and
+// pop; the app uses it with worker producers and the GUI thread as the one consumer.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+template <typename T>
+class BatchRing {
+public:
+    // The capacity is rounded up to a power of two.
+    explicit BatchRing(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; ++i) slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    BatchRing(const BatchRing &) = delete;
+    BatchRing &operator=(const BatchRing &) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // False when the ring is full; `value` is left untouched then.
+    bool tryPush(T &value) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot &slot = slots[pos & mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t lag = intptr_t(sequence) - intptr_t(pos);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    slot.value = std::move(value);
+                    slot.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // False when the ring is empty.
+    bool tryPop(T &value) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot &slot = slots[pos & mask];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const intptr_t lag = intptr_t(sequence) - intptr_t(pos + 1);
+            if (lag == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = std::move(slot.value);
+                    slot.value = T();
+                    slot.sequence.store(pos + mask + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    // One cache line per slot and per index, so producers and the consumer do not
+    // invalidate each other's lines.
+    struct alignas(64) Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> head{ 0 }; // next slot to pop
+    alignas(64) std::atomic<size_t> tail{ 0 }; // next slot to push
+};
@@ -0,0 +1,213 @@
+// Session recording and anonymization. See permcalc_session.h.
+
+#include "permcalc_session.h"
+#include "permcalc_core.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMessageAuthenticationCode>
+#include <QtCore/QRandomGenerator>
+
+#include <memory>
+
+namespace {
+
+constexpr int FormatVersion = 1;
+
+struct TypeName {
+    SessionEvent::Type type;
+    const char *name;
+};
+
+const TypeName TypeNames[] = {
+    { SessionEvent::Type::Paste, "paste" },
+    { SessionEvent::Type::Edit, "edit" },
+    { SessionEvent::Type::Clear, "clear" },
+    { SessionEvent::Type::EditAsText, "edit_as_text" },
+    { SessionEvent::Type::Compare, "compare" },
+};
+
+bool isWordChar(QChar c) {
+    return c.isLetterOrNumber() || c == u'_';
+}
+
+bool isAllDigits(QStringView word) {
+    for (QChar c : word) {
+        if (!c.isDigit()) return false;
+    }
+    return true;
+}
+
+bool overlapsPhrase(const QChar *begin, const QChar *end, const std::pmr::vector<NoisePhraseMatcher::Match> &matches) {
+    for (const NoisePhraseMatcher::Match &match : matches) {
+        if (match.begin < end && begin < match.end) return true;
+    }
+    return false;
+}
+
+std::unique_ptr<SessionRecorder> &activeRecorder() {
+    static std::unique_ptr<SessionRecorder> recorder;
+    return recorder;
+}
+
+} // namespace
+
+SessionAnonymizer::SessionAnonymizer() {
+    key.resize(32);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(key.data()), key.size() / sizeof(quint32));
+}
+
+SessionAnonymizer::SessionAnonymizer(const QByteArray &key) : key(key) {}
+
+QString SessionAnonymizer::anonymize(QStringView text) {
+    QString out;
+    out.reserve(text.size());
+    std::pmr::vector<NoisePhraseMatcher::Match> phrases;
+    qsizetype start = 0;
+    while (start < text.size()) {
+        qsizetype end = text.indexOf(u'\n', start);
+        end = end < 0 ? text.size() : end + 1;
+        const QStringView line = text.mid(start, end - start);
+        phrases.clear();
+        noisePhrases().scan(line, phrases);
+
+        qsizetype i = 0;
+        while (i < line.size()) {
+            if (!isWordChar(line[i])) {
+                out += line[i++];
+                continue;
+            }
+            qsizetype wordEnd = i;
+            while (wordEnd < line.size() && isWordChar(line[wordEnd])) ++wordEnd;
+            const QStringView word = line.mid(i, wordEnd - i);
+            // Kept words steer parsing: action words and dates mark assignment rows.
+            if (isAllDigits(word) || isActionWord(word) || overlapsPhrase(word.begin(), word.end(), phrases)) {
+                out += word;
+            } else {
+                appendPseudonym(word, out);
+            }
+            i = wordEnd;
+        }
+        start = end;
+    }
+    return out;
+}
+
+void SessionAnonymizer::appendPseudonym(QStringView word, QString &out) {
+    const QString folded = word.toString().toLower();
+    auto it = digests.find(folded);
+    if (it == digests.end()) {
+        // One HMAC block per 32 characters, so long words do not repeat a pattern.
+        QByteArray digest;
+        const QByteArray message = folded.toUtf8();
+        for (int block = 0; digest.size() < word.size(); ++block) {
+            digest += QMessageAuthenticationCode::hash(message + QByteArray::number(block), key,
+                                                       QCryptographicHash::Sha256);
+        }
+        it = digests.insert(folded, digest);
+    }
+    const QByteArray &digest = *it;
+    for (qsizetype i = 0; i < word.size(); ++i) {
+        const QChar c = word[i];
+        const uchar byte = uchar(digest[i]);
+        if (c == u'_') {
+            out += c;
+        } else if (c.isDigit()) {
+            out += QChar(u'0' + byte % 10);
+        } else {
+            const QChar letter(u'a' + byte % 26);
+            out += c.isUpper() ? letter.toUpper() : letter;
+        }
+    }
+}
+
+SessionRecorder::SessionRecorder(const QString &path) : file(path) {
+    if (!file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) return;
+    const QJsonObject header{
+        { "type", "session" },
+        { "version", FormatVersion },
+        { "created", QDateTime::currentDateTime().toString(Qt::ISODate) },
+    };
+    file.write(QJsonDocument(header).toJson(QJsonDocument::Compact) + '\n');
+    file.flush();
+    clock.start();
+}
+
+void SessionRecorder::record(SessionEvent event) {
+    if (!file.isOpen()) return;
+    QJsonObject line{ { "t", clock.elapsed() } };
+    for (const TypeName &name : TypeNames) {
+        if (name.type == event.type) line.insert("type", name.name);
+    }
+    if (event.type != SessionEvent::Type::Compare) line.insert("box", event.mirror ? "mirror" : "primary");
+    if (event.type == SessionEvent::Type::Paste || event.type == SessionEvent::Type::Edit) {
+        line.insert("pos", event.position);
+        line.insert("removed", event.removed);
+        line.insert("text", anonymizer.anonymize(event.text));
+    }
+    if (event.durationMs >= 0) line.insert("ms", event.durationMs);
+    // Flushed per event, so a crash loses nothing that led up to it.
+    file.write(QJsonDocument(line).toJson(QJsonDocument::Compact) + '\n');
+    file.flush();
+}
+
+SessionRecorder *sessionRecorder() {
+    return activeRecorder().get();
+}
+
+bool startSessionRecording(const QString &folder) {
+    if (!QDir().mkpath(folder)) return false;
+    // The pid keeps two instances started in the same second apart.
+    const QString name = QString("session-%1-%2.jsonl")
+        .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"))
+        .arg(QCoreApplication::applicationPid());
+    auto recorder = std::make_unique<SessionRecorder>(QDir(folder).filePath(name));
+    if (!recorder->isOpen()) return false;
+    activeRecorder() = std::move(recorder);
+    return true;
+}
+
+bool readSession(const QString &path, std::vector<SessionEvent> &events, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    events.clear();
+    int lineNumber = 0;
+    while (!file.atEnd()) {
+        const QByteArray raw = file.readLine().trimmed();
+        ++lineNumber;
+        if (raw.isEmpty()) continue;
+        const QJsonObject line = QJsonDocument::fromJson(raw).object();
+        const QString type = line.value("type").toString();
+        if (lineNumber == 1) {
+            if (type != QLatin1String("session") || line.value("version").toInt() > FormatVersion) {
+                if (error) *error = "not a session recording of a supported version";
+                return false;
+            }
+            continue;
+        }
+
+        SessionEvent event;
+        bool known = false;
+        for (const TypeName &name : TypeNames) {
+            if (type == QLatin1String(name.name)) {
+                event.type = name.type;
+                known = true;
+            }
+        }
+        if (!known) continue; // written by a newer version
+        event.atMs = qint64(line.value("t").toDouble());
+        event.mirror = line.value("box").toString() == QLatin1String("mirror");
+        event.position = line.value("pos").toInt();
+        event.removed = line.value("removed").toInt();
+        event.text = line.value("text").toString();
+        event.durationMs = line.value("ms").toDouble(-1);
+        events.push_back(std::move(event));
+    }
+    return true;
+}
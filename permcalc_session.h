@@ -0,0 +1,71 @@
+// Anonymized recordings of comparison sessions, kept as a corpus of real-world input
+// for performance regression runs (permcalc_replay).
+//
+// A session file is JSON Lines: a header object, then one object per event. Text is
+// anonymized before it reaches the file, with its structure preserved. Separators,
+// punctuation, line breaks, header and noise phrases, action words ("Add", "Del")
+// and all-digit words (dates, counts) are kept. Every other word is replaced by a
+// keyed hash of the same length, with letters, digits and case in the same places.
+// A word maps to the same replacement wherever it appears, ignoring case, so
+// duplicates and the overlap between the two boxes survive. The key is random per
+// session and never written.
+
+#pragma once
+
+#include <QtCore/QByteArray>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QHash>
+#include <QtCore/QString>
+#include <QtCore/QStringView>
+
+#include <vector>
+
+struct SessionEvent {
+    enum class Type { Paste, Edit, Clear, EditAsText, Compare };
+
+    Type type = Type::Edit;
+    qint64 atMs = 0;       // since the recording started
+    bool mirror = false;   // which input box, for box events
+    int position = 0;      // Paste, Edit: where the change starts
+    int removed = 0;       // Paste, Edit: characters replaced, e.g. a selection
+    QString text;          // Paste, Edit: the inserted text
+    double durationMs = -1; // Paste, Compare: time the app took, when measured
+};
+
+class SessionAnonymizer {
+public:
+    SessionAnonymizer(); // with a random key
+    explicit SessionAnonymizer(const QByteArray &key);
+
+    QString anonymize(QStringView text);
+
+private:
+    void appendPseudonym(QStringView word, QString &out);
+
+    QByteArray key;
+    QHash<QString, QByteArray> digests; // lower-cased word -> keyed hash bytes
+};
+
+class SessionRecorder {
+public:
+    explicit SessionRecorder(const QString &path);
+
+    bool isOpen() const { return file.isOpen(); }
+    QString path() const { return file.fileName(); }
+
+    // Anonymizes the event's text, stamps its time and appends it to the file.
+    void record(SessionEvent event);
+
+private:
+    QFile file;
+    QElapsedTimer clock;
+    SessionAnonymizer anonymizer;
+};
+
+// The recorder of this process, or null while recording is off.
+SessionRecorder *sessionRecorder();
+// Starts recording to a new file in `folder`; false if it cannot be created.
+bool startSessionRecording(const QString &folder);
+
+bool readSession(const QString &path, std::vector<SessionEvent> &events, QString *error = nullptr);
@@ -0,0 +1,183 @@
+// Startup benchmark. Launches SalesforcePermCalc on the offscreen platform with
+// PERMCALC_STARTUP_TRACE set, and reads back the time each startup stage completed:
+//
+//   main            process creation up to main(): loader, DLLs, static initializers
+//   qapplication    QApplication construction: platform plugin and fonts
+//   build_ui        window construction up to the end of buildUi() and buildMenus()
+//   apply_styles    applyStyles()
+//   window_shown    show()
+//   catalog_loaded  first catalog load, from the CSV or its snapshot
+//   first_paint     first complete frame
+//
+// Every stage is reported in milliseconds since launch, plus the increment over the
+// previous stage. A cold run first deletes the catalog snapshots, so the CSV is
+// parsed again. Warm runs follow the cold ones and reuse the snapshot and the OS
+// file cache. The OS file cache itself is not dropped, because that needs
+// administrator rights.
+//
+//   permcalc_startup_bench [--app PATH] [--cold N] [--warm N] [--timeout MS] [--json FILE]
+
+#include "permcalc_bench.h"
+#include "permcalc_core.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QHash>
+#include <QtCore/QProcess>
+#include <QtCore/QSettings>
+#include <QtCore/QTemporaryDir>
+
+#include <chrono>
+#include <iterator>
+
+namespace {
+
+const char *const Stages[] = {
+    "main", "qapplication", "build_ui", "apply_styles", "window_shown", "catalog_loaded", "first_paint",
+};
+
+qint64 wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// The catalogs the app would load, resolved the way loadOrgConfig() does.
+QStringList catalogPaths(const QString &appDir) {
+    const QDir base(appDir);
+    QSettings settings(base.filePath("catalogs.ini"), QSettings::IniFormat);
+    QStringList paths;
+    settings.beginGroup("orgs");
+    for (const QString &org : settings.childKeys()) {
+        const QString path = settings.value(org).toString();
+        if (!path.isEmpty()) paths << QDir::cleanPath(base.absoluteFilePath(path));
+    }
+    settings.endGroup();
+    if (paths.isEmpty()) paths << base.filePath("Permission Sets.csv");
+    return paths;
+}
+
+// Runs the app once. On success `offsets` holds each stage's milliseconds since launch.
+bool launch(const QString &app, const QString &tracePath, int timeoutMs,
+            QHash<QByteArray, double> &offsets, QString &error) {
+    QFile::remove(tracePath);
+
+    QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+    env.insert("QT_QPA_PLATFORM", "offscreen");
+    env.insert("PERMCALC_STARTUP_TRACE", tracePath);
+    QProcess process;
+    process.setProcessEnvironment(env);
+    process.setProcessChannelMode(QProcess::ForwardedChannels);
+    process.setWorkingDirectory(QFileInfo(app).absolutePath());
+
+    const qint64 launched = wallClockNs();
+    process.start(app, QStringList());
+    if (!process.waitForStarted(timeoutMs)) {
+        error = process.errorString();
+        return false;
+    }
+    if (!process.waitForFinished(timeoutMs)) {
+        process.kill();
+        process.waitForFinished();
+        error = QString("no first paint within %1 ms").arg(timeoutMs);
+        return false;
+    }
+
+    QFile trace(tracePath);
+    if (!trace.open(QIODevice::ReadOnly)) {
+        error = "no startup trace: " + trace.errorString();
+        return false;
+    }
+    offsets.clear();
+    while (!trace.atEnd()) {
+        const QList<QByteArray> fields = trace.readLine().trimmed().split(' ');
+        if (fields.size() == 2) offsets.insert(fields[0], (fields[1].toLongLong() - launched) / 1e6);
+    }
+    for (const char *stage : Stages) {
+        if (!offsets.contains(stage)) {
+            error = QString("stage %1 missing from the trace").arg(QLatin1String(stage));
+            return false;
+        }
+    }
+    return true;
+}
+
+bool runMode(const QString &mode, int runs, const QString &app, const QStringList &catalogs,
+             const QString &tracePath, int timeoutMs, std::vector<Benchmark> &results) {
+    const size_t first = results.size();
+    for (const char *stage : Stages) results.push_back({ QString("startup/%1/%2").arg(mode, QLatin1String(stage)), "ms", {} });
+
+    for (int run = 0; run < runs; ++run) {
+        if (mode == QLatin1String("cold")) {
+            for (const QString &csv : catalogs) QFile::remove(snapshotPath(csv));
+        }
+        QHash<QByteArray, double> offsets;
+        QString error;
+        if (!launch(app, tracePath, timeoutMs, offsets, error)) {
+            QTextStream(stdout) << mode << " run " << run + 1 << " failed: " << error << '\n';
+            return false;
+        }
+        size_t i = first;
+        for (const char *stage : Stages) results[i++].samples.push_back(offsets.value(stage));
+    }
+    return true;
+}
+
+// Median time since launch per stage and the increment over the previous stage.
+void printBreakdown(const std::vector<Benchmark> &results, size_t stageCount) {
+    QTextStream out(stdout);
+    out << qSetFieldWidth(16) << Qt::left << "stage" << qSetFieldWidth(12) << Qt::right
+        << "cold ms" << "+ms" << "warm ms" << "+ms" << qSetFieldWidth(0) << '\n';
+    for (size_t i = 0; i < stageCount; ++i) {
+        out << qSetFieldWidth(16) << Qt::left << Stages[i] << qSetFieldWidth(12) << Qt::right;
+        for (size_t mode : { size_t(0), stageCount }) {
+            const double at = median(results[mode + i].samples);
+            const double before = i == 0 ? 0 : median(results[mode + i - 1].samples);
+            out << QString::number(at, 'f', 1) << QString::number(at - before, 'f', 1);
+        }
+        out << qSetFieldWidth(0) << '\n';
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Startup benchmark: time from launch to each startup stage of the app.");
+    parser.addHelpOption();
+    parser.addOption({ "app", "The SalesforcePermCalc executable.", "PATH", PERMCALC_APP_PATH });
+    parser.addOption({ "cold", "Runs without catalog snapshots.", "N", "3" });
+    parser.addOption({ "warm", "Runs with catalog snapshots, after the cold runs.", "N", "10" });
+    parser.addOption({ "timeout", "Milliseconds to wait for each run.", "MS", "30000" });
+    parser.addOption({ "json", "Also write the samples as JSON to FILE.", "FILE" });
+    parser.process(app);
+    const QString appPath = QFileInfo(parser.value("app")).absoluteFilePath();
+    const int cold = std::max(1, parser.value("cold").toInt());
+    const int warm = std::max(1, parser.value("warm").toInt());
+    const int timeoutMs = std::max(1000, parser.value("timeout").toInt());
+
+    QTemporaryDir scratch;
+    if (!scratch.isValid()) {
+        QTextStream(stdout) << "Cannot create a temporary folder: " << scratch.errorString() << '\n';
+        return 1;
+    }
+    const QString tracePath = scratch.filePath("startup.trace");
+    const QStringList catalogs = catalogPaths(QFileInfo(appPath).absolutePath());
+
+    std::vector<Benchmark> results;
+    if (!runMode("cold", cold, appPath, catalogs, tracePath, timeoutMs, results)
+        || !runMode("warm", warm, appPath, catalogs, tracePath, timeoutMs, results)) {
+        return 1;
+    }
+
+    printBreakdown(results, std::size(Stages));
+    QString error;
+    if (parser.isSet("json") && !writeBenchmarkJson(parser.value("json"), results, &error)) {
+        QTextStream(stdout) << "Cannot write " << parser.value("json") << ": " << error << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+// Role template library. See permcalc_templates.h.
+
+#include "permcalc_templates.h"
+#include "permcalc_core.h"
+
+#include <QtCore/QDataStream>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+#include <algorithm>
+
+// File header: magic and format version, then the dictionary, the template count,
+// and per template its name followed by (dictionary size + 63) / 64 words of bits.
+static const quint32 TEMPLATES_MAGIC = 0x50525431; // "PRT1"
+static const quint16 TEMPLATES_VERSION = 1;
+
+static size_t wordsFor(qsizetype bits) {
+    return size_t(bits + 63) / 64;
+}
+
+int RoleTemplateLibrary::indexOf(const QString &name) const {
+    for (int i = 0; i < size(); ++i) {
+        if (templateNames[i].compare(name, Qt::CaseInsensitive) == 0) return i;
+    }
+    return -1;
+}
+
+QStringList RoleTemplateLibrary::permissions(int index) const {
+    QStringList result;
+    const quint64 *row = rows.data() + size_t(index) * words;
+    for (size_t w = 0; w < words; ++w) {
+        for (quint64 bits = row[w]; bits; bits &= bits - 1) {
+            result << dictionary[qsizetype(w * 64 + qCountTrailingZeroBits(bits))];
+        }
+    }
+    return result; // bit order is dictionary order, which is nameLess order
+}
+
+void RoleTemplateLibrary::setTemplate(const QString &name, const QStringList &permissions) {
+    QStringList names = templateNames;
+    std::vector<QStringList> bundles;
+    for (int i = 0; i < size(); ++i) bundles.push_back(this->permissions(i));
+    const int existing = indexOf(name);
+    if (existing >= 0) {
+        names[existing] = name;
+        bundles[size_t(existing)] = permissions;
+    } else {
+        names << name;
+        bundles.push_back(permissions);
+    }
+    rebuild(names, bundles);
+}
+
+bool RoleTemplateLibrary::removeTemplate(const QString &name) {
+    const int index = indexOf(name);
+    if (index < 0) return false;
+    QStringList names = templateNames;
+    std::vector<QStringList> bundles;
+    for (int i = 0; i < size(); ++i) {
+        if (i != index) bundles.push_back(permissions(i));
+    }
+    names.removeAt(index);
+    // Names only the removed template used leave the dictionary with it.
+    rebuild(names, bundles);
+    return true;
+}
+
+// Editing templates is rare, so any change lays the whole library out again. Names
+// are told apart by exact spelling, as ParseSession does for a comparison.
+void RoleTemplateLibrary::rebuild(const QStringList &names, const std::vector<QStringList> &bundles) {
+    dictionary.clear();
+    dictionaryIds.clear();
+    QSet<QString> seen;
+    for (const QStringList &bundle : bundles) {
+        for (const QString &permission : bundle) {
+            if (!permission.isEmpty() && !seen.contains(permission)) {
+                seen.insert(permission);
+                dictionary << permission;
+            }
+        }
+    }
+    std::sort(dictionary.begin(), dictionary.end(), [](const QString &a, const QString &b) { return nameLess(a, b); });
+    for (qsizetype i = 0; i < dictionary.size(); ++i) dictionaryIds.insert(dictionary[i], quint32(i));
+
+    templateNames = names;
+    words = wordsFor(dictionary.size());
+    rows.assign(bundles.size() * words, 0);
+    counts.assign(bundles.size(), 0);
+    for (size_t t = 0; t < bundles.size(); ++t) {
+        quint64 *row = rows.data() + t * words;
+        for (const QString &permission : bundles[t]) {
+            const auto it = dictionaryIds.constFind(permission);
+            if (it == dictionaryIds.cend()) continue;
+            const quint64 bit = quint64(1) << (*it % 64);
+            if (!(row[*it / 64] & bit)) {
+                row[*it / 64] |= bit;
+                ++counts[t];
+            }
+        }
+    }
+}
+
+RoleTemplateLibrary::UserBits RoleTemplateLibrary::encode(const QStringList &userPermissions) const {
+    UserBits user;
+    user.bits.assign(words, 0);
+    QSet<QString> unknown;
+    for (const QString &permission : userPermissions) {
+        const auto it = dictionaryIds.constFind(permission);
+        if (it == dictionaryIds.cend()) {
+            unknown.insert(permission);
+        } else {
+            user.bits[*it / 64] |= quint64(1) << (*it % 64);
+        }
+    }
+    user.size = int(unknown.size());
+    for (quint64 word : user.bits) user.size += qPopulationCount(word);
+    return user;
+}
+
+TemplateMatch RoleTemplateLibrary::score(const UserBits &user, int index) const {
+    const quint64 *row = rows.data() + size_t(index) * words;
+    const quint64 *held = user.bits.data();
+    int shared = 0;
+    // Branch-free AND and popcount over contiguous words, which the compiler
+    // unrolls and vectorizes where the target has a vector popcount.
+    for (size_t w = 0; w < words; ++w) shared += qPopulationCount(row[w] & held[w]);
+
+    TemplateMatch match;
+    match.templateIndex = index;
+    match.shared = shared;
+    match.missing = counts[size_t(index)] - shared;
+    match.extra = user.size - shared;
+    const int total = shared + match.missing + match.extra;
+    match.fit = total > 0 ? double(shared) / total : 1;
+    return match;
+}
+
+TemplateMatch RoleTemplateLibrary::match(const QStringList &userPermissions, int index) const {
+    return score(encode(userPermissions), index);
+}
+
+std::vector<TemplateMatch> RoleTemplateLibrary::matchAll(const QStringList &userPermissions) const {
+    const UserBits user = encode(userPermissions);
+    std::vector<TemplateMatch> matches;
+    matches.reserve(size_t(size()));
+    for (int t = 0; t < size(); ++t) matches.push_back(score(user, t));
+    std::stable_sort(matches.begin(), matches.end(), [](const TemplateMatch &a, const TemplateMatch &b) {
+        if (a.fit != b.fit) return a.fit > b.fit;
+        return a.missing < b.missing;
+    });
+    return matches;
+}
+
+bool RoleTemplateLibrary::load(const QString &path, QString *error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_6_0);
+    quint32 magic = 0;
+    quint16 version = 0;
+    in >> magic >> version;
+    if (magic != TEMPLATES_MAGIC || version != TEMPLATES_VERSION) {
+        if (error) *error = "not a role template file of a supported version";
+        return false;
+    }
+
+    RoleTemplateLibrary loaded;
+    quint32 count = 0;
+    in >> loaded.dictionary >> count;
+    loaded.words = wordsFor(loaded.dictionary.size());
+    // Bits past the end of the dictionary would index names that do not exist.
+    const quint64 lastWordMask = loaded.dictionary.size() % 64 == 0
+        ? ~quint64(0) : (quint64(1) << (loaded.dictionary.size() % 64)) - 1;
+    for (quint32 t = 0; t < count && in.status() == QDataStream::Ok; ++t) {
+        QString name;
+        in >> name;
+        loaded.templateNames << name;
+        int bitCount = 0;
+        for (size_t w = 0; w < loaded.words; ++w) {
+            quint64 bits = 0;
+            in >> bits;
+            if (w + 1 == loaded.words) bits &= lastWordMask;
+            loaded.rows.push_back(bits);
+            bitCount += qPopulationCount(bits);
+        }
+        loaded.counts.push_back(bitCount);
+    }
+    if (in.status() != QDataStream::Ok) {
+        if (error) *error = "the role template file is truncated or damaged";
+        return false;
+    }
+    for (qsizetype i = 0; i < loaded.dictionary.size(); ++i) {
+        loaded.dictionaryIds.insert(loaded.dictionary[i], quint32(i));
+    }
+    *this = std::move(loaded);
+    return true;
+}
+
+bool RoleTemplateLibrary::save(const QString &path, QString *error) const {
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_6_0);
+    out << TEMPLATES_MAGIC << TEMPLATES_VERSION << dictionary << quint32(size());
+    for (int t = 0; t < size(); ++t) {
+        out << templateNames[t];
+        for (size_t w = 0; w < words; ++w) out << rows[size_t(t) * words + w];
+    }
+    if (!file.commit()) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,64 @@
+// Role templates: named bundles of permission sets, such as "Tier 1 Support", that
+// stand in for a mirror user. The library interns every permission set name that
+// any template uses into one dictionary. Each template is a row of bits over that
+// dictionary, and the rows sit back to back in one array. Matching a user against
+// all templates is a single pass over that array: AND with the user's bits and a
+// population count per word.
+//
+// Templates persist in a compact binary file. It holds the dictionary once, then
+// each template's name and its row of bits.
+
+#pragma once
+
+#include <QtCore/QString>
+#include <QtCore/QStringList>
+#include <QtCore/QHash>
+
+#include <vector>
+
+struct TemplateMatch {
+    int templateIndex = -1;
+    int shared = 0;  // in both the template and the user's list
+    int missing = 0; // in the template, not held by the user
+    int extra = 0;   // held by the user, not in the template
+    double fit = 0;  // shared / (shared + missing + extra), 1 for an exact match
+};
+
+class RoleTemplateLibrary {
+public:
+    int size() const { return int(templateNames.size()); }
+    bool isEmpty() const { return templateNames.isEmpty(); }
+    const QStringList &names() const { return templateNames; }
+    int indexOf(const QString &name) const; // case-insensitive; -1 if absent
+
+    // The template's permission sets, in nameLess order.
+    QStringList permissions(int index) const;
+    // Adds the template, or replaces the one with the same name.
+    void setTemplate(const QString &name, const QStringList &permissions);
+    bool removeTemplate(const QString &name);
+
+    TemplateMatch match(const QStringList &userPermissions, int index) const;
+    // Every template against the user's list, best fit first. Ties go to the
+    // template that the user is missing the least of.
+    std::vector<TemplateMatch> matchAll(const QStringList &userPermissions) const;
+
+    bool load(const QString &path, QString *error = nullptr);
+    bool save(const QString &path, QString *error = nullptr) const;
+
+private:
+    struct UserBits {
+        std::vector<quint64> bits;
+        int size = 0; // distinct names, including those no template has
+    };
+
+    UserBits encode(const QStringList &userPermissions) const;
+    TemplateMatch score(const UserBits &user, int index) const;
+    void rebuild(const QStringList &names, const std::vector<QStringList> &bundles);
+
+    QStringList dictionary;                // every name used by a template, nameLess order
+    QHash<QString, quint32> dictionaryIds; // name, exactly as spelled -> bit
+    size_t words = 0;                      // 64-bit words per template row
+    QStringList templateNames;
+    std::vector<quint64> rows;             // size() * words
+    std::vector<int> counts;               // bits set per row
+};
@@ -0,0 +1,211 @@
+// Palette, fonts and proxy style of the Permission Set Comparator. See permcalc_theme.h.
+
+#include "permcalc_theme.h"
+
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QStyleFactory>
+#include <QtWidgets/QStyleOption>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QGroupBox>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QPlainTextEdit>
+#include <QtWidgets/QListView>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QHeaderView>
+#include <QtGui/QPainter>
+#include <QtGui/QFontMetrics>
+
+namespace {
+
+const QColor Canvas("#f0f2f5");
+const QColor Ink("#1c1e21");
+const QColor MutedInk("#4b4f56");
+const QColor Panel("#ffffff");
+const QColor PanelBorder("#dddfe2");
+const QColor InputFill("#f5f6f7");
+const QColor InputBorder("#ccd0d5");
+const QColor Accent("#1877f2");
+const QColor AccentHover("#166fe5");
+const QColor AccentPressed("#155db5");
+const QColor Secondary("#e4e6eb");
+const QColor SecondaryHover("#d8dadf");
+const QColor Disabled("#bcc0c4");
+const QColor RowSeparator("#f0f2f5");
+
+QFont uiFont(int pixelSize, QFont::Weight weight = QFont::Normal) {
+    QFont font(QStringList{ "Segoe UI", "sans-serif" });
+    font.setPixelSize(pixelSize);
+    font.setWeight(weight);
+    return font;
+}
+
+QFont monospaceFont(int pixelSize) {
+    QFont font(QStringList{ "Consolas", "Courier New", "monospace" });
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(pixelSize);
+    return font;
+}
+
+bool isSecondary(const QWidget *widget) {
+    return widget && widget->objectName() == QLatin1String("SecondaryButton");
+}
+
+void fillRounded(QPainter *painter, const QRectF &rect, qreal radius, const QColor &fill, const QColor &border) {
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing);
+    painter->setPen(border.isValid() ? QPen(border, 1) : Qt::NoPen);
+    painter->setBrush(fill);
+    painter->drawRoundedRect(rect.adjusted(0.5, 0.5, -0.5, -0.5), radius, radius);
+    painter->restore();
+}
+
+} // namespace
+
+QPalette permCalcPalette() {
+    QPalette palette;
+    palette.setColor(QPalette::Window, Canvas);
+    palette.setColor(QPalette::WindowText, Ink);
+    palette.setColor(QPalette::Base, Panel);
+    palette.setColor(QPalette::AlternateBase, QColor("#f9fafb"));
+    palette.setColor(QPalette::Text, Ink);
+    palette.setColor(QPalette::Button, Secondary);
+    palette.setColor(QPalette::ButtonText, Ink);
+    palette.setColor(QPalette::Highlight, Accent);
+    palette.setColor(QPalette::HighlightedText, Panel);
+    palette.setColor(QPalette::ToolTipBase, Panel);
+    palette.setColor(QPalette::ToolTipText, Ink);
+    palette.setColor(QPalette::PlaceholderText, QColor("#8a8d91"));
+    palette.setColor(QPalette::Disabled, QPalette::Button, Disabled);
+    palette.setColor(QPalette::Disabled, QPalette::ButtonText, Canvas);
+    return palette;
+}
+
+void applyPermCalcTheme(QApplication &app) {
+    app.setStyle(new PermCalcStyle);
+    app.setPalette(permCalcPalette());
+    app.setFont(uiFont(14));
+}
+
+PermCalcStyle::PermCalcStyle()
+    : QProxyStyle(QStyleFactory::create(QStringLiteral("Fusion"))) {}
+
+void PermCalcStyle::polish(QWidget *widget) {
+    QProxyStyle::polish(widget);
+
+    if (auto *button = qobject_cast<QPushButton *>(widget)) {
+        button->setAttribute(Qt::WA_Hover);
+        button->setFont(uiFont(16, QFont::DemiBold));
+        QPalette palette = button->palette();
+        if (!isSecondary(button)) {
+            palette.setColor(QPalette::Active, QPalette::Button, Accent);
+            palette.setColor(QPalette::Inactive, QPalette::Button, Accent);
+            palette.setColor(QPalette::Active, QPalette::ButtonText, Panel);
+            palette.setColor(QPalette::Inactive, QPalette::ButtonText, Panel);
+        }
+        button->setPalette(palette);
+    } else if (auto *group = qobject_cast<QGroupBox *>(widget)) {
+        group->setFont(uiFont(14, QFont::DemiBold));
+        QPalette palette = group->palette();
+        palette.setColor(QPalette::WindowText, MutedInk);
+        group->setPalette(palette);
+    } else if (qobject_cast<QLabel *>(widget) && widget->objectName() == QLatin1String("HeaderLabel")) {
+        widget->setFont(uiFont(28, QFont::Bold));
+    } else if (qobject_cast<QPlainTextEdit *>(widget) || qobject_cast<QListView *>(widget)) {
+        // Group box fonts are bold and would otherwise be inherited.
+        widget->setFont(monospaceFont(13));
+        QPalette palette = widget->palette();
+        palette.setColor(QPalette::Base, InputFill);
+        widget->setPalette(palette);
+    } else if (qobject_cast<QHeaderView *>(widget)) {
+        widget->setFont(uiFont(14, QFont::DemiBold));
+        QPalette palette = widget->palette();
+        palette.setColor(QPalette::ButtonText, MutedInk);
+        widget->setPalette(palette);
+    } else if (qobject_cast<QTableView *>(widget)) {
+        widget->setFont(uiFont(13));
+    }
+}
+
+void PermCalcStyle::drawPrimitive(PrimitiveElement element, const QStyleOption *option, QPainter *painter,
+                                  const QWidget *widget) const {
+    switch (element) {
+    case PE_PanelButtonCommand: {
+        const bool enabled = option->state & State_Enabled;
+        const bool pressed = option->state & (State_Sunken | State_On);
+        const bool hovered = option->state & State_MouseOver;
+        QColor fill;
+        if (!enabled) fill = Disabled;
+        else if (isSecondary(widget)) fill = hovered || pressed ? SecondaryHover : Secondary;
+        else fill = pressed ? AccentPressed : hovered ? AccentHover : Accent;
+        fillRounded(painter, option->rect, 6, fill, QColor());
+        return;
+    }
+    case PE_FrameGroupBox:
+        fillRounded(painter, option->rect, 8, Panel, PanelBorder);
+        return;
+    case PE_Frame:
+    case PE_FrameLineEdit: {
+        const bool focused = (option->state & State_HasFocus) && qobject_cast<const QPlainTextEdit *>(widget);
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(focused ? Accent : InputBorder, 1));
+        painter->setBrush(Qt::NoBrush);
+        painter->drawRoundedRect(QRectF(option->rect).adjusted(0.5, 0.5, -0.5, -0.5), 6, 6);
+        painter->restore();
+        return;
+    }
+    case PE_FrameFocusRect:
+        return;
+    default:
+        QProxyStyle::drawPrimitive(element, option, painter, widget);
+    }
+}
+
+void PermCalcStyle::drawControl(ControlElement element, const QStyleOption *option, QPainter *painter,
+                                const QWidget *widget) const {
+    if (element == CE_HeaderSection) {
+        painter->fillRect(option->rect, Canvas);
+        painter->setPen(PanelBorder);
+        painter->drawLine(option->rect.bottomLeft(), option->rect.bottomRight());
+        return;
+    }
+    QProxyStyle::drawControl(element, option, painter, widget);
+}
+
+int PermCalcStyle::pixelMetric(PixelMetric metric, const QStyleOption *option, const QWidget *widget) const {
+    switch (metric) {
+    case PM_ButtonMargin:
+        return isSecondary(widget) ? 48 : 24;
+    case PM_DefaultFrameWidth:
+        return 1;
+    default:
+        return QProxyStyle::pixelMetric(metric, option, widget);
+    }
+}
+
+void ResultRowDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    QStyleOptionViewItem opt(option);
+    initStyleOption(&opt, index);
+
+    const bool selected = opt.state & QStyle::State_Selected;
+    if (selected) {
+        painter->fillRect(opt.rect, opt.palette.highlight());
+    } else if (opt.backgroundBrush.style() != Qt::NoBrush) {
+        painter->fillRect(opt.rect, opt.backgroundBrush);
+    } else if (opt.features & QStyleOptionViewItem::Alternate) {
+        painter->fillRect(opt.rect, opt.palette.alternateBase());
+    }
+    painter->setPen(RowSeparator);
+    painter->drawLine(opt.rect.bottomLeft(), opt.rect.bottomRight());
+
+    const QRect textRect = opt.rect.adjusted(8, 0, -8, 0);
+    painter->setFont(opt.font);
+    painter->setPen(opt.palette.color(selected ? QPalette::HighlightedText : QPalette::Text));
+    const QFontMetrics metrics(opt.font);
+    painter->drawText(textRect, Qt::AlignVCenter | Qt::AlignLeft,
+                      metrics.elidedText(opt.text, Qt::ElideRight, textRect.width()));
+}
+
+QSize ResultRowDelegate::sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const {
+    return QSize(QStyledItemDelegate::sizeHint(option, index).width() + 16, RowHeight);
+}
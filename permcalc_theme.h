@@ -0,0 +1,47 @@
+// Look of the Permission Set Comparator, delivered through a palette, fonts and a
+// proxy style rather than a style sheet. A style sheet routes every widget and
+// every item paint through Qt's style-sheet engine; this theme keeps the native
+// paint paths and only overrides the few primitives that need the app's look.
+
+#pragma once
+
+#include <QtWidgets/QProxyStyle>
+#include <QtWidgets/QStyledItemDelegate>
+#include <QtGui/QPalette>
+
+class QApplication;
+
+QPalette permCalcPalette();
+
+// Installs the palette, application font and PermCalcStyle on the application.
+void applyPermCalcTheme(QApplication &app);
+
+// Fusion with rounded buttons, input frames and group panels, and per-widget fonts
+// and colors assigned once in polish(). Buttons named "SecondaryButton" are grey.
+class PermCalcStyle : public QProxyStyle {
+public:
+    PermCalcStyle();
+
+    void polish(QWidget *widget) override;
+    using QProxyStyle::polish;
+
+    void drawPrimitive(PrimitiveElement element, const QStyleOption *option, QPainter *painter,
+                       const QWidget *widget = nullptr) const override;
+    void drawControl(ControlElement element, const QStyleOption *option, QPainter *painter,
+                     const QWidget *widget = nullptr) const override;
+    int pixelMetric(PixelMetric metric, const QStyleOption *option = nullptr,
+                    const QWidget *widget = nullptr) const override;
+};
+
+// Paints result table cells directly: background or selection highlight, a row
+// separator and one line of elided text with the theme's padding. Rows have a fixed
+// height of RowHeight.
+class ResultRowDelegate : public QStyledItemDelegate {
+public:
+    static constexpr int RowHeight = 34;
+
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+    QSize sizeHint(const QStyleOptionViewItem &option, const QModelIndex &index) const override;
+};
@@ -0,0 +1,202 @@
+// UI benchmark for comparison results. Drives the real PermissionSetCalculator window
+// offscreen with synthetic comparisons of each requested size. Half of the names are
+// shared, a quarter are missing and a quarter are extra. For each size it times:
+//
+//   diff         parse and set difference alone, in a bare ParseSession
+//   populate     the whole Compare step: parse, diff and filling the result model
+//   first_paint  item layout plus the first paint of the result table
+//   scroll       paint of one viewport while paging through the whole table
+//   resize       re-layout of the window plus a table paint after its width changes
+//
+//   permcalc_ui_bench [--rows 100,1000,10000,100000] [--repeat N] [--json FILE]
+//   permcalc_ui_bench --check-strategies [--seed N]
+//
+// --check-strategies times nothing. It runs ParseSession::diff on random inputs with
+// each SetStrategy and exits with 1 if any two disagree on missing, extra or shared.
+//
+// Runs on the offscreen platform unless QT_QPA_PLATFORM says otherwise. Results go
+// to stdout as a table, and with --json as {"benchmarks": [{name, unit, samples}]}.
+
+#include "permcalc_bench.h"
+#include "permcalc_core.h"
+#include "permcalc_window.h"
+
+#include <QtWidgets/QApplication>
+#include <QtWidgets/QMainWindow>
+#include <QtWidgets/QTableView>
+#include <QtWidgets/QScrollBar>
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QRandomGenerator>
+#include <QtGui/QImage>
+
+#include <memory>
+
+namespace {
+
+struct SyntheticInput {
+    QString user;
+    QString mirror;
+};
+
+SyntheticInput syntheticInput(int rows) {
+    QStringList user;
+    QStringList mirror;
+    for (int i = 0; i < rows; ++i) {
+        const QString name = QString("Bench_Permission_Set_%1").arg(i, 6, 10, QLatin1Char('0'));
+        switch (i % 4) {
+        case 0:
+        case 1: user << name; mirror << name; break; // shared
+        case 2: mirror << name; break;                // missing
+        default: user << name; break;                 // extra
+        }
+    }
+    return { user.join(u'\n'), mirror.join(u'\n') };
+}
+
+double elapsedMs(const QElapsedTimer &timer) {
+    return double(timer.nsecsElapsed()) / 1e6;
+}
+
+const char *strategyName(SetStrategy strategy) {
+    switch (strategy) {
+    case SetStrategy::Auto: return "Auto";
+    case SetStrategy::Hash: return "Hash";
+    case SetStrategy::Merge: return "Merge";
+    case SetStrategy::Gallop: return "Gallop";
+    case SetStrategy::Bitset: return "Bitset";
+    }
+    return "?";
+}
+
+// Random picks from `pool` names, some of them in the catalog and some repeated,
+// one per line.
+QString randomNames(QRandomGenerator &random, int count, int pool) {
+    QStringList names;
+    for (int i = 0; i < count; ++i) {
+        const int n = int(random.bounded(pool));
+        names << (n % 2 == 0 ? QString("Catalog_Set_%1").arg(n / 2) : QString("Local_Set_%1").arg(n / 2));
+    }
+    return names.join(u'\n');
+}
+
+// Compares every explicit strategy with Hash over sizes from empty to lopsided to
+// large, and over pools from dense (bitset territory) to sparse. Returns the
+// number of disagreements.
+int checkStrategies(quint32 seed) {
+    QTextStream out(stdout);
+    QString csv = "Permission Set ID,Permission Set API Name,Permission Set Name,Description\n";
+    for (int i = 0; i < 5000; ++i) csv += QString("0PS%1,Catalog_Set_%1,Catalog_Set_%1,Synthetic\n").arg(i);
+    const CatalogSnapshot catalog = std::make_shared<const PermissionCatalog>(parseCatalogText(csv));
+
+    const int sizes[] = { 0, 1, 7, 60, 500, 5000, 40000 };
+    const int pools[] = { 16, 1000, 20000, 1000000 };
+    const SetStrategy strategies[] = { SetStrategy::Merge, SetStrategy::Gallop, SetStrategy::Bitset };
+    QRandomGenerator random(seed);
+    ParseSession session;
+    int cases = 0;
+    int failures = 0;
+    for (int userSize : sizes) {
+        for (int mirrorSize : sizes) {
+            for (int pool : pools) {
+                session.reset(catalog);
+                const ParseSession::IdList user = session.parse(randomNames(random, userSize, pool));
+                const ParseSession::IdList mirror = session.parse(randomNames(random, mirrorSize, pool));
+                const ParseSession::Diff expected = session.diff(user, mirror, SetStrategy::Hash);
+                for (SetStrategy strategy : strategies) {
+                    const ParseSession::Diff actual = session.diff(user, mirror, strategy);
+                    ++cases;
+                    if (actual.missing == expected.missing && actual.extra == expected.extra
+                        && actual.shared == expected.shared) {
+                        continue;
+                    }
+                    ++failures;
+                    out << strategyName(strategy) << " differs from Hash for " << userSize << " user and "
+                        << mirrorSize << " mirror names from a pool of " << pool << ": missing "
+                        << actual.missing.size() << " vs " << expected.missing.size() << ", extra "
+                        << actual.extra.size() << " vs " << expected.extra.size() << ", shared "
+                        << actual.shared.size() << " vs " << expected.shared.size() << '\n';
+                }
+            }
+        }
+    }
+    out << cases << " comparisons, " << failures << " disagreements (seed " << seed << ")\n";
+    return failures;
+}
+
+void runSize(QMainWindow &window, int rows, int repeat, std::vector<Benchmark> &results) {
+    const SyntheticInput input = syntheticInput(rows);
+    QTableView *view = comparisonTable(&window);
+    QImage frame(QSize(1280, 1024), QImage::Format_ARGB32_Premultiplied);
+
+    const QString prefix = QString("ui/%1_rows/").arg(rows);
+    Benchmark diff{ prefix + "diff", "ms", {} };
+    Benchmark populate{ prefix + "populate", "ms", {} };
+    Benchmark firstPaint{ prefix + "first_paint", "ms", {} };
+    Benchmark scroll{ prefix + "scroll", "us/frame", {} };
+    Benchmark resize{ prefix + "resize", "us/resize", {} };
+
+    ParseSession session;
+    QElapsedTimer timer;
+    for (int i = 0; i < repeat; ++i) {
+        timer.start();
+        session.reset(nullptr);
+        const ParseSession::IdList userIds = session.parse(input.user);
+        const ParseSession::IdList mirrorIds = session.parse(input.mirror);
+        session.diff(userIds, mirrorIds);
+        diff.samples.push_back(elapsedMs(timer));
+
+        timer.start();
+        comparePermissionTexts(&window, input.user, input.mirror);
+        populate.samples.push_back(elapsedMs(timer));
+
+        timer.start();
+        view->doItemsLayout();
+        QCoreApplication::sendPostedEvents();
+        view->viewport()->render(&frame);
+        firstPaint.samples.push_back(elapsedMs(timer));
+
+        view->verticalScrollBar()->setValue(0);
+        scroll.samples.push_back(scrollPass(*view, frame));
+        resize.samples.push_back(resizePass(window, *view, frame, { 760, 1100, 900, 1280, 900 }));
+    }
+    for (Benchmark *b : { &diff, &populate, &firstPaint, &scroll, &resize }) results.push_back(std::move(*b));
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Result table benchmark: population, paint, scroll and resize of the app window.");
+    parser.addHelpOption();
+    parser.addOption({ "rows", "Comma-separated result sizes.", "N,...", "100,1000,10000,100000" });
+    parser.addOption({ "repeat", "Measured passes per size.", "N", "5" });
+    parser.addOption({ "json", "Also write the samples as JSON to FILE.", "FILE" });
+    parser.addOption({ "check-strategies", "Check that all diff strategies agree on random inputs, then exit." });
+    parser.addOption({ "seed", "Random seed of --check-strategies.", "N", "1" });
+    parser.process(app);
+    if (parser.isSet("check-strategies")) return checkStrategies(parser.value("seed").toUInt()) > 0 ? 1 : 0;
+    const int repeat = std::max(1, parser.value("repeat").toInt());
+
+    std::unique_ptr<QMainWindow> window(createPermissionSetCalculator());
+    window->resize(900, 800);
+    window->show();
+    QCoreApplication::processEvents();
+
+    std::vector<Benchmark> results;
+    for (const QString &size : parser.value("rows").split(u',', Qt::SkipEmptyParts)) {
+        const int rows = size.trimmed().toInt();
+        if (rows > 0) runSize(*window, rows, repeat, results);
+    }
+
+    printBenchmarks(results);
+    QString error;
+    if (parser.isSet("json") && !writeBenchmarkJson(parser.value("json"), results, &error)) {
+        QTextStream(stdout) << "Cannot write " << parser.value("json") << ": " << error << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,189 @@
+// Event-loop stall watchdog. See permcalc_watchdog.h.
+
+#include "permcalc_watchdog.h"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QDateTime>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+constexpr int HeartbeatMs = 50;
+constexpr int SampleMs = 25;
+constexpr int MaxDepth = 8;
+constexpr int MaxSizes = 3;
+constexpr int MaxStacksPerStall = 8;
+constexpr qint64 MaxLogBytes = 1024 * 1024;
+
+qint64 nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::atomic<StageTimingSink> timingSink{ nullptr };
+
+struct ActiveStage {
+    const char *name = nullptr;
+    StageSize sizes[MaxSizes] = {};
+    int sizeCount = 0;
+};
+
+// Stages the GUI thread is inside, innermost last. Written by the GUI thread and
+// read by the watchdog.
+struct StageBoard {
+    std::mutex lock;
+    ActiveStage stack[MaxDepth];
+    int depth = 0; // may exceed MaxDepth; deeper stages are not recorded
+    ActiveStage lastFinished;
+    qint64 lastFinishedAt = -1;
+};
+
+StageBoard &stageBoard() {
+    static StageBoard board;
+    return board;
+}
+
+bool onGuiThread() {
+    const QCoreApplication *app = QCoreApplication::instance();
+    return app && QThread::currentThread() == app->thread();
+}
+
+QString describe(const ActiveStage &stage) {
+    QString text = QString::fromLatin1(stage.name);
+    if (stage.sizeCount == 0) return text;
+    QStringList sizes;
+    for (int i = 0; i < stage.sizeCount; ++i) {
+        sizes << QString("%1=%2").arg(QLatin1String(stage.sizes[i].label)).arg(stage.sizes[i].value);
+    }
+    return text + '(' + sizes.join(", ") + ')';
+}
+
+// "outer > inner" for the stages active right now, or the stage that finished last
+// if it finished after `since`.
+QString describeActiveStages(qint64 since) {
+    StageBoard &board = stageBoard();
+    std::lock_guard<std::mutex> guard(board.lock);
+    QStringList stack;
+    for (int i = 0; i < std::min(board.depth, MaxDepth); ++i) stack << describe(board.stack[i]);
+    if (!stack.isEmpty()) return stack.join(" > ");
+    if (board.lastFinished.name && board.lastFinishedAt >= since) return "after " + describe(board.lastFinished);
+    return "no instrumented stage";
+}
+
+} // namespace
+
+void setStageTimingSink(StageTimingSink sink) {
+    timingSink.store(sink);
+}
+
+StageScope::StageScope(const char *stage, std::initializer_list<StageSize> sizes) {
+    if (!onGuiThread()) return;
+    name = stage;
+    if (timingSink.load(std::memory_order_relaxed)) startedNs = nowNs();
+    StageBoard &board = stageBoard();
+    std::lock_guard<std::mutex> guard(board.lock);
+    if (board.depth < MaxDepth) {
+        ActiveStage &active = board.stack[board.depth];
+        active.name = stage;
+        active.sizeCount = 0;
+        for (const StageSize &size : sizes) {
+            if (active.sizeCount == MaxSizes) break;
+            active.sizes[active.sizeCount++] = size;
+        }
+    }
+    ++board.depth;
+}
+
+StageScope::~StageScope() {
+    if (!name) return;
+    if (startedNs >= 0) {
+        if (StageTimingSink sink = timingSink.load(std::memory_order_relaxed)) sink(name, nowNs() - startedNs);
+    }
+    StageBoard &board = stageBoard();
+    std::lock_guard<std::mutex> guard(board.lock);
+    --board.depth;
+    if (board.depth < MaxDepth) {
+        board.lastFinished = board.stack[board.depth];
+        board.lastFinishedAt = nowMs();
+    }
+}
+
+StallWatchdog::StallWatchdog(const QString &logPath, int thresholdMs)
+    : logPath(logPath), thresholdMs(thresholdMs), heartbeat(new QTimer), lastBeat(nowMs()) {
+    heartbeat->setInterval(HeartbeatMs);
+    heartbeat->setTimerType(Qt::PreciseTimer);
+    QObject::connect(heartbeat.get(), &QTimer::timeout, heartbeat.get(), [this] { lastBeat.store(nowMs()); });
+    heartbeat->start();
+    thread = std::thread([this] { watch(); });
+}
+
+StallWatchdog::~StallWatchdog() {
+    {
+        std::lock_guard<std::mutex> guard(stopLock);
+        stopping = true;
+    }
+    stopSignal.notify_all();
+    thread.join();
+}
+
+QString StallWatchdog::defaultLogPath() {
+    return QDir(QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath("stalls.log");
+}
+
+void StallWatchdog::watch() {
+    qint64 stallStart = -1;
+    qint64 lastSample = nowMs();
+    QStringList stages;
+    std::unique_lock<std::mutex> lock(stopLock);
+    while (!stopSignal.wait_for(lock, std::chrono::milliseconds(SampleMs), [this] { return stopping; })) {
+        const qint64 now = nowMs();
+        const qint64 beat = lastBeat.load();
+        // This thread missed its own wake-ups as well, so the whole process was
+        // suspended (sleep, debugger) rather than the event loop stalled.
+        const bool suspended = now - lastSample > thresholdMs;
+        lastSample = now;
+        if (suspended) {
+            stallStart = -1;
+        } else if (now - beat > thresholdMs) {
+            if (stallStart < 0) {
+                stallStart = beat;
+                stages.clear();
+            }
+            // A long freeze can pass through several stages; keep each distinct one.
+            const QString active = describeActiveStages(stallStart);
+            if ((stages.isEmpty() || stages.last() != active) && stages.size() < MaxStacksPerStall) stages << active;
+        } else if (stallStart >= 0) {
+            writeReport(beat - stallStart, stages);
+            stallStart = -1;
+        }
+    }
+}
+
+void StallWatchdog::writeReport(qint64 durationMs, const QStringList &stages) {
+    QDir().mkpath(QFileInfo(logPath).absolutePath());
+    if (QFileInfo(logPath).size() > MaxLogBytes) {
+        QFile::remove(logPath + ".1");
+        QFile::rename(logPath, logPath + ".1");
+    }
+    QFile log(logPath);
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return;
+    const QString line = QString("%1 stall %2 ms: %3\n")
+        .arg(QDateTime::currentDateTime().toString(Qt::ISODateWithMs))
+        .arg(durationMs)
+        .arg(stages.join(" | then "));
+    log.write(line.toUtf8());
+}
@@ -0,0 +1,74 @@
+// Event-loop stall watchdog. A timer on the GUI thread records a heartbeat, and a
+// watchdog thread samples it. When the heartbeat is overdue by more than the
+// threshold, the watchdog notes which instrumented stages the GUI thread is inside.
+// Once the loop runs again, it appends one line per stall to a log file:
+//
+//   2026-10-17T14:03:22.481 stall 1840 ms: comparePermissions(user chars=8200000, mirror chars=8100000) > table population(rows=210000)
+//
+// Stages are marked with StageScope. Scopes on other threads are ignored, since only
+// the GUI thread can freeze the window.
+
+#pragma once
+
+#include <QtCore/QString>
+
+#include <atomic>
+#include <condition_variable>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class QTimer;
+
+struct StageSize {
+    const char *label;
+    qint64 value;
+};
+
+// Marks the GUI thread as inside `stage` until the end of the scope. `stage` and the
+// size labels must be string literals.
+class StageScope {
+public:
+    explicit StageScope(const char *stage, std::initializer_list<StageSize> sizes = {});
+    ~StageScope();
+    StageScope(const StageScope &) = delete;
+    StageScope &operator=(const StageScope &) = delete;
+
+private:
+    const char *name = nullptr; // set while the stage is recorded
+    qint64 startedNs = -1;      // set while a timing sink is installed
+};
+
+// Receives the duration of every GUI-thread stage as it ends; used by permcalc_replay.
+// Nested stages are reported on their own and are included in their parent's time.
+using StageTimingSink = void (*)(const char *stage, qint64 nanoseconds);
+void setStageTimingSink(StageTimingSink sink);
+
+class StallWatchdog {
+public:
+    static constexpr int DefaultThresholdMs = 100;
+
+    // Starts watching the event loop of the calling thread, which must be the GUI
+    // thread. The log is rotated to "<logPath>.1" once it passes 1 MB.
+    explicit StallWatchdog(const QString &logPath, int thresholdMs = DefaultThresholdMs);
+    ~StallWatchdog();
+    StallWatchdog(const StallWatchdog &) = delete;
+    StallWatchdog &operator=(const StallWatchdog &) = delete;
+
+    // "stalls.log" in the app's local data folder.
+    static QString defaultLogPath();
+
+private:
+    void watch();
+    void writeReport(qint64 durationMs, const QStringList &stages);
+
+    const QString logPath;
+    const int thresholdMs;
+    std::unique_ptr<QTimer> heartbeat;
+    std::atomic<qint64> lastBeat;
+    std::mutex stopLock;
+    std::condition_variable stopSignal;
+    bool stopping = false; // guarded by stopLock
+    std::thread thread;
+};
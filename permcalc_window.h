@@ -0,0 +1,35 @@
+// Entry points into the main window of the Permission Set Comparator, which lives in
+// perm_set_calculator.cpp. Used by the app's main() and by the UI benchmark.
+
+#pragma once
+
+class QIcon;
+class QMainWindow;
+class QString;
+class QTableView;
+struct SessionEvent;
+
+QMainWindow *createPermissionSetCalculator();
+
+// Compares two texts as the Compare button does with the contents of the two boxes,
+// and shows the result in the window's table. `window` must come from
+// createPermissionSetCalculator().
+void comparePermissionTexts(QMainWindow *window, const QString &userText, const QString &mirrorText);
+QTableView *comparisonTable(QMainWindow *window);
+
+// Repeats a recorded event (permcalc_session.h) on `window` through the same code
+// the user's action ran. Returns once the event's work on the GUI thread is done.
+void replaySessionEvent(QMainWindow *window, const SessionEvent &event);
+
+// Records the session to the app's local data folder (sessions/) when catalogs.ini
+// has recordSessions=true in [diagnostics].
+void startConfiguredSessionRecording();
+
+// The application icon, compiled in at the sizes of the .ico (resources.qrc).
+const QIcon &appIcon();
+
+// Startup tracing for permcalc_startup_bench. With PERMCALC_STARTUP_TRACE set to a
+// file path, each startup stage appends "<stage> <wall-clock nanoseconds>" to that
+// file the first time it completes, and the app quits once it has painted its first
+// frame and loaded its catalog. Without the variable every call returns at once.
+void markStartup(const char *stage);